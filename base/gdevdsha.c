@@ -34,6 +34,25 @@ gx_devn_diff(frac31 devn1[], frac31 devn2[], int num)
     return false;
 }
 
+/*
+ * Split the per-pixel color increment cg_num / cg_den into an integral
+ * part and a remainder in [0, cg_den), so that stepping by one pixel
+ * needs no division. The fraction f is kept in [0, cg_den) by the callers,
+ * so the result is identical to dividing f + cg_num by cg_den.
+ */
+static inline void
+split_color_gradient(int32_t num, int32_t den, int32_t *q, ulong *r)
+{
+    int32_t qq = num / den, rr = num - qq * den;
+
+    if (rr < 0) {
+        qq--;
+        rr += den;
+    }
+    *q = qq;
+    *r = rr;
+}
+
 int
 gx_hl_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *fa,
         int i0, int j, int w, const frac31 *c0, const int32_t *c0f,
@@ -42,10 +61,12 @@ gx_hl_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *fa,
     frac31 c[GX_DEVICE_COLOR_MAX_COMPONENTS];
     frac31 curr[GX_DEVICE_COLOR_MAX_COMPONENTS];
     ulong f[GX_DEVICE_COLOR_MAX_COMPONENTS];
+    int32_t cg_q[GX_DEVICE_COLOR_MAX_COMPONENTS];
+    ulong cg_r[GX_DEVICE_COLOR_MAX_COMPONENTS];
     int i, i1 = i0 + w, bi = i0, k;
     const gx_device_color_info *cinfo = &dev->color_info;
     int n = cinfo->num_components;
-    int si, ei, di, code;
+    int si, ei, di, same = 0, code;
     gs_fixed_rect rect;
     gx_device_color devc;
 
@@ -59,19 +80,19 @@ gx_hl_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *fa,
     for (k = 0; k < n; k++) {
         curr[k] = c[k] = c0[k];
         f[k] = c0f[k];
+        split_color_gradient(cg_num[k], cg_den, &cg_q[k], &cg_r[k]);
     }
     for (i = i0 + 1, di = 1; i < i1; i += di) {
         if (di == 1) {
             /* Advance colors by 1 pixel. */
             for (k = 0; k < n; k++) {
                 if (cg_num[k]) {
-                    int32_t m = f[k] + cg_num[k];
+                    ulong m = f[k] + cg_r[k];
 
-                    c[k] += m / cg_den;
-                    m -= m / cg_den * cg_den;
-                    if (m < 0) {
-                        c[k]--;
-                        m += cg_den;
+                    c[k] += cg_q[k];
+                    if (m >= (ulong)cg_den) {
+                        c[k]++;
+                        m -= cg_den;
                     }
                     f[k] = m;
                 }
@@ -120,11 +141,18 @@ gx_hl_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *fa,
                 curr[k] = c[k];
             }
             di = 1;
+            same = 0;
         } else if (i == i1) {
             i++;
             break;
+        } else if (di > 1 || ++same < 3) {
+            /* A jump stops right before a color change, and with steep
+               gradients the color changes every few pixels, so stepping
+               is cheaper than solving for the next change. */
+            di = 1;
         } else {
             /* Compute a color change pixel analytically. */
+            same = 0;
             di = i1 - i;
             for (k = 0; k < n; k++) {
                 int32_t a;
@@ -142,7 +170,7 @@ gx_hl_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *fa,
                     /* Solve[(f[k] + cg_num[k]*x)/cg_den == - u - 1, x]  */
                     a = -u - 1;
                 }
-                x = ((int64_t)a * cg_den - f[k]) / cg_num[k];
+                x = ((int64_t)a * cg_den - (int64_t)f[k]) / cg_num[k];
                 if (i + x >= i1)
                     continue;
                 else if (x < 0)
@@ -194,11 +222,13 @@ gx_default_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *
     bool devn = dev_proc(dev, dev_spec_op)(dev, gxdso_supports_devn, NULL, 0);
     frac31 c[GX_DEVICE_COLOR_MAX_COMPONENTS];
     ulong f[GX_DEVICE_COLOR_MAX_COMPONENTS];
+    int32_t cg_q[GX_DEVICE_COLOR_MAX_COMPONENTS];
+    ulong cg_r[GX_DEVICE_COLOR_MAX_COMPONENTS];
     int i, i1 = i0 + w, bi = i0, k;
     gx_color_index ci0 = 0, ci1;
     const gx_device_color_info *cinfo = &dev->color_info;
     int n = cinfo->num_components;
-    int si, ei, di, code;
+    int si, ei, di, same = 0, code;
     /* If the device encodes tags, we expect the comp_shift[num_components] to be valid */
     /* for the tag part of the color (usually the high order bits of the color_index).  */
     gx_color_index tag = device_encodes_tags(dev) ?
@@ -218,6 +248,7 @@ gx_default_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *
 
         c[k] = c0[k];
         f[k] = c0f[k];
+        split_color_gradient(cg_num[k], cg_den, &cg_q[k], &cg_r[k]);
         ci0 |= (gx_color_index)(c[k] >> (sizeof(c[k]) * 8 - 1 - bits)) << shift;
     }
     for (i = i0 + 1, di = 1; i < i1; i += di) {
@@ -229,13 +260,12 @@ gx_default_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *
                 int bits = cinfo->comp_bits[k];
 
                 if (cg_num[k]) {
-                    int32_t m = f[k] + cg_num[k];
+                    ulong m = f[k] + cg_r[k];
 
-                    c[k] += m / cg_den;
-                    m -= m / cg_den * cg_den;
-                    if (m < 0) {
-                        c[k]--;
-                        m += cg_den;
+                    c[k] += cg_q[k];
+                    if (m >= (ulong)cg_den) {
+                        c[k]++;
+                        m -= cg_den;
                     }
                     f[k] = m;
                 }
@@ -279,11 +309,18 @@ gx_default_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *
             bi = i;
             ci0 = ci1;
             di = 1;
+            same = 0;
         } else if (i == i1) {
             i++;
             break;
+        } else if (di > 1 || ++same < 3) {
+            /* A jump stops right before a color change, and with steep
+               gradients the color changes every few pixels, so stepping
+               is cheaper than solving for the next change. */
+            di = 1;
         } else {
             /* Compute a color change pixel analitically. */
+            same = 0;
             di = i1 - i;
             for (k = 0; k < n; k++) {
                 int32_t a;
@@ -301,7 +338,7 @@ gx_default_fill_linear_color_scanline(gx_device *dev, const gs_fill_attributes *
                     /* Solve[(f[k] + cg_num[k]*x)/cg_den == - u - 1, x]  */
                     a = -u - 1;
                 }
-                x = ((int64_t)a * cg_den - f[k]) / cg_num[k];
+                x = ((int64_t)a * cg_den - (int64_t)f[k]) / cg_num[k];
                 if (i + x >= i1)
                     continue;
                 else if (x < 0)
@@ -313,9 +313,21 @@ mem_mono_strip_copy_rop_dev(gx_device * dev, const byte * sdata,
          * not likely to be a win with rop_run. */
         /* Loop over scan lines. */
         const rop_proc proc = rop_proc_table[rop];
+        /* If the result doesn't depend on D (halftone fills are T or ~T),
+         * each row repeats every rep_width bits, i.e. every 'period'
+         * bytes. Only the first period of a wide row is built a byte at
+         * a time; the rest is replicated with block copies. */
+        int rep_width = textures->rep_width;
+        int period = ((rep_width & 7) == 0 ? rep_width >> 3 :
+                      (rep_width & 3) == 0 ? rep_width >> 2 :
+                      (rep_width & 1) == 0 ? rep_width >> 1 : rep_width);
+        int head = -x & 7;
+        int seed_width = (!rop3_uses_D(rop) && width > head + (period << 4) ?
+                          head + (period << 3) : width);
+
         for (; line_count-- > 0; drow += draster, ++ty) {
             int dx = x;
-            int w = width;
+            int w = seed_width;
             const byte *trow = textures->data + (ty % textures->rep_height) * traster;
             int xoff = x_offset(phase_x, ty, textures);
             int nw;
@@ -355,6 +367,26 @@ mem_mono_strip_copy_rop_dev(gx_device * dev, const byte * sdata,
                              (result & mask) | (dbyte & ~mask));
                 }
             }
+            if (seed_width < width) {
+                byte *dfirst = drow + ((x + 7) >> 3);
+                int end = x + width;
+                int total = (end >> 3) - ((x + 7) >> 3);
+                int done = period;
+
+                /* Double the replicated run until the row is full. */
+                while (done < total) {
+                    int n = min(done, total - done);
+
+                    memcpy(dfirst + done, dfirst, n);
+                    done += n;
+                }
+                if (end & 7) {
+                    byte *dlast = drow + (end >> 3);
+                    byte rmask = 0xff << (8 - (end & 7));
+
+                    *dlast = (dlast[-period] & rmask) | (*dlast & ~rmask);
+                }
+            }
         }
     } else {
         /* Do it the old, 'slow' way. rop runs of less than 1 word are
@@ -18,6 +18,7 @@
 #include "gx.h"
 #include "gserrors.h"
 #include "gsbitops.h"
+#include "gsflip.h"
 #include "gxdevice.h"
 #include "gxdcolor.h"		/* for gx_fill_rectangle_device_rop */
 #include "gxpcolor.h"           /* for gx_dc_devn_masked */
@@ -836,6 +837,28 @@ loop_entry:
 }
 #endif
 
+/*
+ * Return 1 if the planes are all the same depth and fill the chunky pixel
+ * in order from the most significant bits (plane 0 first), -1 if they
+ * fill it from the least significant bits, or 0 if neither.
+ */
+static int
+planar_chunky_order(const gx_device_memory *mdev)
+{
+    int num_planes = mdev->color_info.num_components;
+    int plane_depth = mdev->plane_depth;
+    int order, pi;
+
+    if (plane_depth == 0 || mdev->color_info.depth != num_planes * plane_depth)
+        return 0;
+    order = (mdev->planes[0].shift == 0 ? -1 : 1);
+    for (pi = 0; pi < num_planes; ++pi)
+        if (mdev->planes[order < 0 ? pi : num_planes - 1 - pi].shift !=
+            pi * plane_depth)
+            return 0;
+    return order;
+}
+
 /* Copy a color bitmap. */
 /* This is slow and messy. */
 static int
@@ -852,6 +875,7 @@ mem_planar_copy_color(gx_device * dev, const byte * base, int sourcex,
     } buf;
     int source_depth = dev->color_info.depth;
     mem_save_params_t save;
+    int order;
     uchar pi;
 
     /* This routine cannot copy from 3bit chunky data, as 3 bit
@@ -863,6 +887,25 @@ mem_planar_copy_color(gx_device * dev, const byte * base, int sourcex,
         source_depth = 4;
 
     fit_copy(dev, base, sourcex, sraster, id, x, y, w, h);
+    order = planar_chunky_order(mdev);
+    if (order != 0 && (mdev->plane_depth == 8 || mdev->plane_depth == 16)) {
+        /* Whole byte samples in sequence: split each row of the source */
+        /* straight into the planes. */
+        int num_planes = mdev->color_info.num_components;
+        int sample_bytes = mdev->plane_depth >> 3;
+        const byte *sptr = base + sourcex * num_planes * sample_bytes;
+        byte *dptr[GX_DEVICE_COLOR_MAX_COMPONENTS];
+        int iy;
+
+        for (iy = y; iy < y + h; ++iy, sptr += sraster) {
+            for (pi = 0; pi < num_planes; ++pi)
+                dptr[order > 0 ? pi : num_planes - 1 - pi] =
+                    mdev->line_ptrs[mdev->height * pi + iy];
+            image_unflip_planes(dptr, x * sample_bytes, sptr, w * sample_bytes,
+                                num_planes, mdev->plane_depth);
+        }
+        return 0;
+    }
     MEM_SAVE_PARAMS(mdev, save);
     for (pi = 0; pi < mdev->color_info.num_components; ++pi) {
         int plane_depth = mdev->planes[pi].depth;
@@ -1745,29 +1788,15 @@ planar_to_chunky(gx_device_memory *mdev, int x, int y, int w, int h,
 {
     int num_planes = mdev->color_info.num_components;
     const byte *sptr[GX_DEVICE_COLOR_MAX_COMPONENTS];
+    const byte *fptr[GX_DEVICE_COLOR_MAX_COMPONENTS];
     int sbit[GX_DEVICE_COLOR_MAX_COMPONENTS];
     byte *dptr;
     int dbit;
     byte dbbyte;
     int ddepth = mdev->color_info.depth;
-    int direct =
-        (mdev->color_info.depth != num_planes * mdev->plane_depth ? 0 :
-         mdev->planes[0].shift == 0 ? -mdev->plane_depth : mdev->plane_depth);
+    int order = planar_chunky_order(mdev);
     int pi, ix, iy;
 
-    /* Check whether the planes are of equal size and sequential. */
-    /* If direct != 0, we already know they exactly fill the depth. */
-    if (direct < 0) {
-        for (pi = 0; pi < num_planes; ++pi)
-            if (mdev->planes[pi].shift != pi * -direct) {
-                direct = 0; break;
-            }
-    } else if (direct > 0) {
-        for (pi = 0; pi < num_planes; ++pi)
-            if (mdev->planes[num_planes - 1 - pi].shift != pi * direct) {
-                direct = 0; break;
-            }
-    }
     for (iy = y; iy < y + h; ++iy) {
         byte **line_ptr = line_ptrs + iy;
 
@@ -1784,36 +1813,31 @@ planar_to_chunky(gx_device_memory *mdev, int x, int y, int w, int h,
             dptr = dest + (iy - y) * draster + (xbit >> 3);
             dbit = xbit & 7;
         }
-        if (direct == -8) {
-            /* 1 byte per component, lsb first. */
-            switch (num_planes) {
-            case 3: {
-                const byte *p0 = sptr[2];
-                const byte *p1 = sptr[1];
-                const byte *p2 = sptr[0];
-
-                for (ix = w; ix > 0; --ix, dptr += 3) {
-                    dptr[0] = *p0++;
-                    dptr[1] = *p1++;
-                    dptr[2] = *p2++;
-                }
-            }
-            continue;
-            case 4:
-                for (ix = w; ix > 0; --ix, dptr += 4) {
-                    dptr[0] = *sptr[3]++;
-                    dptr[1] = *sptr[2]++;
-                    dptr[2] = *sptr[1]++;
-                    dptr[3] = *sptr[0]++;
-                }
-                continue;
-            default:
-                break;
+        ix = w;
+        if (order != 0 && dbit == 0 && sbit[0] == 0) {
+            /*
+             * The planes fill the pixels in sequence and start on byte
+             * boundaries: flip whole bytes of them at once, and leave any
+             * odd pixels at the end to the loop below.  image_flip_planes
+             * takes the planes in chunky order, most significant first.
+             */
+            int nbytes = (w * mdev->plane_depth) >> 3;
+
+            for (pi = 0; pi < num_planes; ++pi)
+                fptr[pi] = sptr[order < 0 ? num_planes - 1 - pi : pi];
+            if (image_flip_planes(dptr, fptr, 0, nbytes, num_planes,
+                                  mdev->plane_depth) >= 0) {
+                for (pi = 0; pi < num_planes; ++pi)
+                    sptr[pi] += nbytes;
+                dptr += nbytes * num_planes;
+                ix -= (nbytes << 3) / mdev->plane_depth;
+                if (ix == 0)
+                    continue;
             }
         }
         dbbyte = (dbit ? (byte)(*dptr & (0xff00 >> dbit)) : 0);
 /*        sample_store_preload(dbbyte, dptr, dbit, ddepth);*/
-        for (ix = w; ix > 0; --ix) {
+        for (; ix > 0; --ix) {
             gx_color_index color = 0;
 
             for (pi = 0; pi < num_planes; ++pi) {
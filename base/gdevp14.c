@@ -55,6 +55,7 @@
 #include "gxclist.h"
 #include "gxiclass.h"
 #include "gximage.h"
+#include "gxht_thresh.h"
 #include "gsmatrix.h"
 #include "gxdevsop.h"
 #include "gsicc.h"
@@ -1991,6 +1992,31 @@ pdf14_put_image(gx_device * dev, gs_gstate * pgs, gx_device * target)
             return 0;
         }
     }
+    /*
+     * A halftoned target with one bit per component, whose colors are
+     * the group's, gets the group thresholded directly instead of being
+     * drawn as an image a pixel at a time.
+     */
+    if (!pdev->using_blend_cs && gx_device_must_halftone(target) &&
+        target->color_info.num_components == num_comp) {
+        code = dev_proc(dev, get_profile)(dev, &dev_profile);
+        if (code < 0)
+            return code;
+        if (dev_profile->device_profile[0]->hashcode ==
+            dev_target_profile->device_profile[0]->hashcode) {
+            if (!data_blended) {
+                gx_blend_image_buffer(buf_ptr, width, height, buf->rowstride,
+                                      buf->planestride, num_comp, bg);
+                data_blended = true;
+            }
+            code = gxht_thresh_put_planes(target, pgs, buf_ptr,
+                                          buf->planestride, buf->rowstride,
+                                          num_comp, rect.p.x, rect.p.y,
+                                          width, height);
+            if (code != 0)
+                return code < 0 ? code : 0;
+        }
+    }
     /*
      * Set color space in preparation for sending an image.
      */
@@ -751,6 +751,71 @@ splay_insert(clump_t *cp, gs_ref_memory_t *mem)
     splay_move_to_root(cp, mem);
 }
 
+/* Rebalancing uses the Day-Stout-Warren algorithm: first rotate the tree
+ * into a 'vine' (a right-leaning list), then repeatedly rotate alternate
+ * nodes of the vine left. This takes linear time and no extra storage. */
+static void
+splay_compress(clump_t *root, uint count)
+{
+    clump_t *scanner = root;
+
+    while (count--) {
+        clump_t *child = scanner->right;
+
+        scanner->right = child->right;
+        scanner = scanner->right;
+        child->right = scanner->left;
+        scanner->left = child;
+    }
+}
+
+static void
+splay_set_parents(clump_t *cp, clump_t *parent)
+{
+    while (cp) {
+        cp->parent = parent;
+        splay_set_parents(cp->left, cp);
+        parent = cp;
+        cp = cp->right;
+    }
+}
+
+void
+clump_splay_balance(gs_ref_memory_t *imem)
+{
+    clump_t pseudo_root;
+    clump_t *tail = &pseudo_root;
+    clump_t *rest = imem->root;
+    uint size = 0, leaves, full = 1;
+
+    pseudo_root.right = rest;
+    while (rest) {
+        if (rest->left == NULL) {
+            tail = rest;
+            rest = rest->right;
+            size++;
+        } else {
+            clump_t *temp = rest->left;
+
+            rest->left = temp->right;
+            temp->right = rest;
+            rest = temp;
+            tail->right = temp;
+        }
+    }
+    while (full * 2 <= size + 1)
+        full *= 2;
+    leaves = size + 1 - full;
+    splay_compress(&pseudo_root, leaves);
+    size -= leaves;
+    while (size > 1) {
+        size /= 2;
+        splay_compress(&pseudo_root, size);
+    }
+    imem->root = pseudo_root.right;
+    splay_set_parents(imem->root, NULL);
+}
+
 /*
  * Allocate and mostly initialize the state of an allocator (system, global,
  * or local).  Does not initialize global or space.
@@ -779,6 +844,8 @@ ialloc_alloc_state(gs_memory_t * parent, uint clump_size)
     iimem->is_controlled = false;
     iimem->gc_status.vm_threshold = clump_size * 3L;
     iimem->gc_status.max_vm = max_long;
+    iimem->gc_status.vm_threshold_scale = 0;
+    iimem->gc_status.num_threads = 0;
     iimem->gc_status.signal_value = 0;
     iimem->gc_status.enabled = false;
     iimem->gc_status.requested = 0;
@@ -953,6 +1020,12 @@ ialloc_set_limit(register gs_ref_memory_t * mem)
          * we stop allocating when allocated + previous_status.allocated
          * exceeds the lesser of max_vm or (if GC is enabled)
          * gc_allocated + vm_threshold.
+         *
+         * If vm_threshold_scale is set, the interval grows with the
+         * amount of VM that survived the last GC, so that a large,
+         * long-lived VM (typically global VM full of fonts and
+         * resources) is traced in proportion to the allocation rate
+         * rather than once every vm_threshold bytes.
          */
     ulong max_allocated =
     (mem->gc_status.max_vm > mem->previous_status.allocated ?
@@ -960,7 +1033,17 @@ ialloc_set_limit(register gs_ref_memory_t * mem)
      0);
 
     if (mem->gc_status.enabled) {
-        ulong limit = mem->gc_allocated + mem->gc_status.vm_threshold;
+        ulong threshold = mem->gc_status.vm_threshold;
+        ulong limit;
+
+        if (mem->gc_status.vm_threshold_scale > 0) {
+            ulong scaled = mem->gc_allocated / 100 *
+                mem->gc_status.vm_threshold_scale;
+
+            if (scaled > threshold)
+                threshold = scaled;
+        }
+        limit = mem->gc_allocated + threshold;
 
         if (limit < mem->previous_status.allocated)
             mem->limit = 0;
@@ -1086,6 +1169,36 @@ gs_memory_set_vm_threshold(gs_ref_memory_t * mem, long val)
     gs_memory_set_gc_status(stable, &stat);
 }
 
+/* Set the VM threshold scale (percentage of surviving VM). */
+void
+gs_memory_set_vm_threshold_scale(gs_ref_memory_t * mem, int val)
+{
+    gs_memory_gc_status_t stat;
+    gs_ref_memory_t * stable = (gs_ref_memory_t *)mem->stable_memory;
+
+    gs_memory_gc_status(mem, &stat);
+    stat.vm_threshold_scale = val;
+    gs_memory_set_gc_status(mem, &stat);
+    gs_memory_gc_status(stable, &stat);
+    stat.vm_threshold_scale = val;
+    gs_memory_set_gc_status(stable, &stat);
+}
+
+/* Set the number of GC relocation threads. */
+void
+gs_memory_set_gc_threads(gs_ref_memory_t * mem, int val)
+{
+    gs_memory_gc_status_t stat;
+    gs_ref_memory_t * stable = (gs_ref_memory_t *)mem->stable_memory;
+
+    gs_memory_gc_status(mem, &stat);
+    stat.num_threads = val;
+    gs_memory_set_gc_status(mem, &stat);
+    gs_memory_gc_status(stable, &stat);
+    stat.num_threads = val;
+    gs_memory_set_gc_status(stable, &stat);
+}
+
 /* Set VM reclaim. */
 void
 gs_memory_set_vm_reclaim(gs_ref_memory_t * mem, bool enabled)
@@ -2604,15 +2717,12 @@ alloc_free_clump(clump_t * cp, gs_ref_memory_t * mem)
     gs_free_object(parent, cp, "alloc_free_clump(clump struct)");
 }
 
-/* Find the clump for a pointer. */
-/* Note that this only searches the current save level. */
-/* Since a given save level can't contain both a clump and an inner clump */
-/* of that clump, we can stop when is_within_clump succeeds, and just test */
-/* is_in_inner_clump then. */
-bool
-clump_locate_ptr(const void *ptr, clump_locator_t * clp)
+/* Find the clump whose extent contains a pointer, without changing */
+/* the splay tree. */
+static clump_t *
+clump_search_ptr(const void *ptr, gs_ref_memory_t *mem)
 {
-    clump_t *cp = clp->memory->root;
+    clump_t *cp = mem->root;
 
     while (cp)
     {
@@ -2627,34 +2737,48 @@ clump_locate_ptr(const void *ptr, clump_locator_t * clp)
             continue;
         }
         /* Found it! */
-        splay_move_to_root(cp, clp->memory);
-        clp->cp = cp;
-        return !ptr_is_in_inner_clump(ptr, cp);
+        return cp;
     }
-    return false;
+    return 0;
+}
+
+/* Find the clump for a pointer. */
+/* Note that this only searches the current save level. */
+/* Since a given save level can't contain both a clump and an inner clump */
+/* of that clump, we can stop when is_within_clump succeeds, and just test */
+/* is_in_inner_clump then. */
+bool
+clump_locate_ptr(const void *ptr, clump_locator_t * clp)
+{
+    clump_t *cp = clump_search_ptr(ptr, clp->memory);
+
+    if (cp == 0)
+        return false;
+    splay_move_to_root(cp, clp->memory);
+    clp->cp = cp;
+    return !ptr_is_in_inner_clump(ptr, cp);
+}
+
+/* As clump_locate_ptr, but leave the tree alone. */
+bool
+clump_find_ptr(const void *ptr, clump_locator_t * clp)
+{
+    clump_t *cp = clump_search_ptr(ptr, clp->memory);
+
+    if (cp == 0)
+        return false;
+    clp->cp = cp;
+    return !ptr_is_in_inner_clump(ptr, cp);
 }
 
 bool ptr_is_within_mem_clumps(const void *ptr, gs_ref_memory_t *mem)
 {
-    clump_t *cp = mem->root;
+    clump_t *cp = clump_search_ptr(ptr, mem);
 
-    while (cp)
-    {
-        if (PTR_LT(ptr, cp->cbase))
-        {
-            cp = cp->left;
-            continue;
-        }
-        if (PTR_GE(ptr, cp->cend))
-        {
-            cp = cp->right;
-            continue;
-        }
-        /* Found it! */
-        splay_move_to_root(cp, mem);
-        return true;
-    }
-    return false;
+    if (cp == 0)
+        return false;
+    splay_move_to_root(cp, mem);
+    return true;
 }
 
 /* ------ Debugging ------ */
@@ -33,6 +33,11 @@ typedef struct gs_memory_gc_status_s {
         /* Set by client */
     long vm_threshold;		/* GC interval */
     long max_vm;		/* maximum allowed allocation */
+    int vm_threshold_scale;	/* if > 0, the GC interval is at least */
+                                /* this percentage of the VM that */
+                                /* survived the last GC */
+    int num_threads;		/* # of additional threads used to */
+                                /* relocate pointers during GC */
 
     int signal_value;		/* value to store in gs_lib_ctx->gcsignal */
     bool enabled;		/* auto GC enabled if true */
@@ -42,6 +47,8 @@ typedef struct gs_memory_gc_status_s {
 void gs_memory_gc_status(const gs_ref_memory_t *, gs_memory_gc_status_t *);
 void gs_memory_set_gc_status(gs_ref_memory_t *, const gs_memory_gc_status_t *);
 void gs_memory_set_vm_threshold(gs_ref_memory_t * mem, long val);
+void gs_memory_set_vm_threshold_scale(gs_ref_memory_t * mem, int val);
+void gs_memory_set_gc_threads(gs_ref_memory_t * mem, int val);
 void gs_memory_set_vm_reclaim(gs_ref_memory_t * mem, bool enabled);
 
 /* ------ Initialization ------ */
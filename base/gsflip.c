@@ -39,6 +39,12 @@ typedef uint byte_var;
 #define VTAB(v80,v40,v20,v10,v8,v4,v2,v1)\
   bit_table_8(0,v80,v40,v20,v10,v8,v4,v2,v1)
 
+#ifdef HAVE_SSE2
+/* 4 planes of 8 or 16 bit samples are interleaved (and split again) */
+/* 16 bytes of each plane at a time. */
+#include <emmintrin.h>
+#endif
+
 /* Convert 3Mx1 to 3x1. */
 static int
 flip3x1(byte * buffer, const byte ** planes, int offset, int nbytes)
@@ -245,6 +251,22 @@ flip4x8(byte * buffer, const byte ** planes, int offset, int nbytes)
     const byte *in4 = planes[3] + offset;
     int n = nbytes;
 
+#ifdef HAVE_SSE2
+    for (; n >= 16; out += 64, in1 += 16, in2 += 16, in3 += 16, in4 += 16,
+             n -= 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)in1);
+        __m128i b = _mm_loadu_si128((const __m128i *)in2);
+        __m128i c = _mm_loadu_si128((const __m128i *)in3);
+        __m128i d = _mm_loadu_si128((const __m128i *)in4);
+        __m128i ab0 = _mm_unpacklo_epi8(a, b), ab1 = _mm_unpackhi_epi8(a, b);
+        __m128i cd0 = _mm_unpacklo_epi8(c, d), cd1 = _mm_unpackhi_epi8(c, d);
+
+        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(ab0, cd0));
+        _mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi16(ab0, cd0));
+        _mm_storeu_si128((__m128i *)(out + 32), _mm_unpacklo_epi16(ab1, cd1));
+        _mm_storeu_si128((__m128i *)(out + 48), _mm_unpackhi_epi16(ab1, cd1));
+    }
+#endif
     for (; n > 0; out += 4, ++in1, ++in2, ++in3, ++in4, --n) {
         out[0] = *in1;
         out[1] = *in2;
@@ -350,6 +372,84 @@ flipNx12(byte * buffer, const byte ** planes, int offset, int nbytes,
     return 0;
 }
 
+/* Convert NMx8 to Nx8. */
+static int
+flipNx8(byte * buffer, const byte ** planes, int offset, int nbytes,
+        int num_planes, int ignore_bits_per_sample)
+{
+    int pi, n;
+
+    /* Store each plane in turn: the output is touched num_planes times, */
+    /* but each loop is a simple strided copy. */
+    for (pi = 0; pi < num_planes; ++pi) {
+        const byte *in = planes[pi] + offset;
+        byte *out = buffer + pi;
+
+        for (n = nbytes; n > 0; out += num_planes, --n)
+            *out = *in++;
+    }
+    return 0;
+}
+
+/* Convert NMx16 to Nx16. */
+static int
+flipNx16(byte * buffer, const byte ** planes, int offset, int nbytes,
+         int num_planes, int ignore_bits_per_sample)
+{
+    int step = num_planes * 2;
+    int pi, n;
+
+    for (pi = 0; pi < num_planes; ++pi) {
+        const byte *in = planes[pi] + offset;
+        byte *out = buffer + pi * 2;
+
+        for (n = nbytes; n > 0; in += 2, out += step, n -= 2) {
+            out[0] = in[0];
+            out[1] = in[1];
+        }
+    }
+    return 0;
+}
+
+/* Convert 3Mx16 to 3x16. */
+static int
+flip3x16(byte * buffer, const byte ** planes, int offset, int nbytes)
+{
+    return flipNx16(buffer, planes, offset, nbytes, 3, 16);
+}
+
+/* Convert 4Mx16 to 4x16. */
+static int
+flip4x16(byte * buffer, const byte ** planes, int offset, int nbytes)
+{
+#ifdef HAVE_SSE2
+    const byte *sp[4];
+    int n = nbytes & ~15;
+    int i;
+
+    for (i = 0; i < n; i += 16, buffer += 64) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(planes[0] + offset + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(planes[1] + offset + i));
+        __m128i c = _mm_loadu_si128((const __m128i *)(planes[2] + offset + i));
+        __m128i d = _mm_loadu_si128((const __m128i *)(planes[3] + offset + i));
+        __m128i ab0 = _mm_unpacklo_epi16(a, b), ab1 = _mm_unpackhi_epi16(a, b);
+        __m128i cd0 = _mm_unpacklo_epi16(c, d), cd1 = _mm_unpackhi_epi16(c, d);
+
+        _mm_storeu_si128((__m128i *)buffer, _mm_unpacklo_epi32(ab0, cd0));
+        _mm_storeu_si128((__m128i *)(buffer + 16), _mm_unpackhi_epi32(ab0, cd0));
+        _mm_storeu_si128((__m128i *)(buffer + 32), _mm_unpacklo_epi32(ab1, cd1));
+        _mm_storeu_si128((__m128i *)(buffer + 48), _mm_unpackhi_epi32(ab1, cd1));
+    }
+    if (n == nbytes)
+        return 0;
+    for (i = 0; i < 4; ++i)
+        sp[i] = planes[i] + offset + n;
+    return flipNx16(buffer, sp, 0, nbytes - n, 4, 16);
+#else
+    return flipNx16(buffer, planes, offset, nbytes, 4, 16);
+#endif
+}
+
 /* Flip data given number of planes and bits per pixel. */
 typedef int (*image_flip_proc) (byte *, const byte **, int, int);
 static int
@@ -357,15 +457,17 @@ flip_fail(byte * buffer, const byte ** planes, int offset, int nbytes)
 {
     return -1;
 }
-static const image_flip_proc image_flip3_procs[13] = {
+static const image_flip_proc image_flip3_procs[17] = {
     flip_fail, flip3x1, flip3x2, flip_fail, flip3x4,
     flip_fail, flip_fail, flip_fail, flip3x8,
-    flip_fail, flip_fail, flip_fail, flip3x12
+    flip_fail, flip_fail, flip_fail, flip3x12,
+    flip_fail, flip_fail, flip_fail, flip3x16
 };
-static const image_flip_proc image_flip4_procs[13] = {
+static const image_flip_proc image_flip4_procs[17] = {
     flip_fail, flip4x1, flip4x2, flip_fail, flip4x4,
     flip_fail, flip_fail, flip_fail, flip4x8,
-    flip_fail, flip_fail, flip_fail, flip4x12
+    flip_fail, flip_fail, flip_fail, flip4x12,
+    flip_fail, flip_fail, flip_fail, flip4x16
 };
 typedef int (*image_flipN_proc) (byte *, const byte **, int, int, int, int);
 static int
@@ -374,10 +476,11 @@ flipN_fail(byte * buffer, const byte ** planes, int offset, int nbytes,
 {
     return -1;
 }
-static const image_flipN_proc image_flipN_procs[13] = {
+static const image_flipN_proc image_flipN_procs[17] = {
     flipN_fail, flipNx1to8, flipNx1to8, flipN_fail, flipNx1to8,
-    flipN_fail, flipN_fail, flipN_fail, flipNx1to8,
-    flipN_fail, flipN_fail, flipN_fail, flipNx12
+    flipN_fail, flipN_fail, flipN_fail, flipNx8,
+    flipN_fail, flipN_fail, flipN_fail, flipNx12,
+    flipN_fail, flipN_fail, flipN_fail, flipNx16
 };
 
 /* Here is the public interface to all of the above. */
@@ -385,7 +488,7 @@ int
 image_flip_planes(byte * buffer, const byte ** planes, int offset, int nbytes,
                   int num_planes, int bits_per_sample)
 {
-    if (bits_per_sample < 1 || bits_per_sample > 12)
+    if (bits_per_sample < 1 || bits_per_sample > 16)
         return -1;
     switch (num_planes) {
 
@@ -402,3 +505,141 @@ image_flip_planes(byte * buffer, const byte ** planes, int offset, int nbytes,
             (buffer, planes, offset, nbytes, num_planes, bits_per_sample);
     }
 }
+
+/* ---------------- Chunky to planar ---------------- */
+
+/* Convert Nx{1,2,4} to NMx{1,2,4}. */
+static int
+unflipNx1to4(byte ** planes, int offset, const byte * buffer, int nbytes,
+             int num_planes, int bits_per_sample)
+{
+    /* Like flipNx1to8, this is only needed for DeviceN colors. */
+    uint mask = (1 << bits_per_sample) - 1;
+    int count = nbytes * 8 / bits_per_sample;
+    int pi, i;
+
+    for (pi = 0; pi < num_planes; ++pi) {
+        byte *dptr = planes[pi] + offset;
+        int dbit = 0;
+        byte dbbyte = 0;
+        int bi = pi * bits_per_sample;
+
+        for (i = 0; i < count; ++i, bi += num_planes * bits_per_sample) {
+            uint value =
+                (buffer[bi >> 3] >> (8 - (bi & 7) - bits_per_sample)) & mask;
+
+            if (sample_store_next8(value, &dptr, &dbit, bits_per_sample, &dbbyte) < 0)
+                return_error(gs_error_rangecheck);
+        }
+        sample_store_flush(dptr, dbit, dbbyte);
+    }
+    return 0;
+}
+
+/* Convert 4x8 to 4Mx8. */
+static int
+unflip4x8(byte ** planes, int offset, const byte * buffer, int nbytes)
+{
+    const byte *in = buffer;
+    byte *out[4];
+    int n = nbytes;
+    int pi;
+
+    for (pi = 0; pi < 4; ++pi)
+        out[pi] = planes[pi] + offset;
+#ifdef HAVE_SSE2
+    /* Take each sample of 16 pixels out of its 32-bit lane, and pack the */
+    /* lanes down to bytes.  SSE2 is always little-endian, so the first */
+    /* sample of a pixel is the low byte of its lane. */
+    {
+        const __m128i lo = _mm_set1_epi32(0xff);
+
+        for (; n >= 16; in += 64, n -= 16) {
+            __m128i p0 = _mm_loadu_si128((const __m128i *)in);
+            __m128i p1 = _mm_loadu_si128((const __m128i *)(in + 16));
+            __m128i p2 = _mm_loadu_si128((const __m128i *)(in + 32));
+            __m128i p3 = _mm_loadu_si128((const __m128i *)(in + 48));
+
+            for (pi = 0; pi < 4; ++pi) {
+                __m128i s01 = _mm_packs_epi32(_mm_and_si128(p0, lo),
+                                              _mm_and_si128(p1, lo));
+                __m128i s23 = _mm_packs_epi32(_mm_and_si128(p2, lo),
+                                              _mm_and_si128(p3, lo));
+
+                _mm_storeu_si128((__m128i *)out[pi], _mm_packus_epi16(s01, s23));
+                out[pi] += 16;
+                p0 = _mm_srli_epi32(p0, 8);
+                p1 = _mm_srli_epi32(p1, 8);
+                p2 = _mm_srli_epi32(p2, 8);
+                p3 = _mm_srli_epi32(p3, 8);
+            }
+        }
+    }
+#endif
+    for (; n > 0; in += 4, --n) {
+        *out[0]++ = in[0];
+        *out[1]++ = in[1];
+        *out[2]++ = in[2];
+        *out[3]++ = in[3];
+    }
+    return 0;
+}
+
+/* Convert Nx8 to NMx8. */
+static int
+unflipNx8(byte ** planes, int offset, const byte * buffer, int nbytes,
+          int num_planes)
+{
+    int pi, n;
+
+    for (pi = 0; pi < num_planes; ++pi) {
+        const byte *in = buffer + pi;
+        byte *out = planes[pi] + offset;
+
+        for (n = nbytes; n > 0; in += num_planes, --n)
+            *out++ = *in;
+    }
+    return 0;
+}
+
+/* Convert Nx16 to NMx16. */
+static int
+unflipNx16(byte ** planes, int offset, const byte * buffer, int nbytes,
+           int num_planes)
+{
+    int step = num_planes * 2;
+    int pi, n;
+
+    for (pi = 0; pi < num_planes; ++pi) {
+        const byte *in = buffer + pi * 2;
+        byte *out = planes[pi] + offset;
+
+        for (n = nbytes; n > 0; in += step, out += 2, n -= 2) {
+            out[0] = in[0];
+            out[1] = in[1];
+        }
+    }
+    return 0;
+}
+
+/* The public interface for the inverse of image_flip_planes. */
+int
+image_unflip_planes(byte ** planes, int offset, const byte * buffer,
+                    int nbytes, int num_planes, int bits_per_sample)
+{
+    if (num_planes < 1)
+        return -1;
+    switch (bits_per_sample) {
+    case 1: case 2: case 4:
+        return unflipNx1to4(planes, offset, buffer, nbytes, num_planes,
+                            bits_per_sample);
+    case 8:
+        if (num_planes == 4)
+            return unflip4x8(planes, offset, buffer, nbytes);
+        return unflipNx8(planes, offset, buffer, nbytes, num_planes);
+    case 16:
+        return unflipNx16(planes, offset, buffer, nbytes, num_planes);
+    default:
+        return -1;
+    }
+}
@@ -25,11 +25,24 @@
  * output is stored at buffer.  This procedure assumes that the input
  * consists of an integral number of pixels; in particular, for 12-bit
  * input, nbytes is rounded up to a multiple of 3.  num_planes must be >=0;
- * bits_per_sample must be 1, 2, 4, 8, or 12.  Returns -1 if num_planes or
- * bits_per_sample is invalid, otherwise 0.
+ * bits_per_sample must be 1, 2, 4, 8, 12, or 16.  Returns -1 if num_planes
+ * or bits_per_sample is invalid, otherwise 0.  Planar memory devices also
+ * use this to return chunky data; the 4 plane cases at 8 and 16 bits use
+ * SSE2 when it is available (HAVE_SSE2).
  */
 extern int image_flip_planes(byte * buffer, const byte ** planes,
                              int offset, int nbytes,
                              int num_planes, int bits_per_sample);
 
+/*
+ * The inverse of image_flip_planes: split num_planes * nbytes bytes of
+ * chunky data at buffer into nbytes bytes of each of the planes, stored
+ * at planes[0] + offset ... planes[num_planes-1] + offset.  num_planes
+ * must be >0; bits_per_sample must be 1, 2, 4, 8, or 16.  Returns -1 if
+ * num_planes or bits_per_sample is invalid, otherwise 0.
+ */
+extern int image_unflip_planes(byte ** planes, int offset,
+                               const byte * buffer, int nbytes,
+                               int num_planes, int bits_per_sample);
+
 #endif /* gsflip_INCLUDED */
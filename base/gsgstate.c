@@ -28,6 +28,7 @@
 #include "gzht.h"
 #include "gzline.h"
 #include "gxfmap.h"
+#include "gxpaint.h"
 #include "gsicc_cache.h"
 #include "gsicc_manage.h"
 #include "gsicc_profilecache.h"
@@ -93,6 +94,10 @@ static RELOC_PTRS_WITH(gs_gstate_reloc_ptrs, gs_gstate *gisvptr)
         for (; i >= 0; i--)
             RELOC_PTR(gs_gstate, effective_transfer[i]);
     }
+    /* The stroke cache isn't traced, but it knows its owner's address. */
+    if (gisvptr->stroke_cache != 0 &&
+        gx_stroke_cache_owner(gisvptr->stroke_cache) == gisvptr)
+        gx_stroke_cache_set_owner(gisvptr->stroke_cache, RELOC_OBJ(gisvptr));
 } RELOC_PTRS_END
 
 /* Initialize an gs_gstate, other than the parts covered by */
@@ -134,6 +139,7 @@ gs_gstate_initialize(gs_gstate * pgs, gs_memory_t * mem)
     pgs->cie_joint_caches_alt = NULL;
     pgs->cmap_procs = cmap_procs_default;
     pgs->pattern_cache = NULL;
+    pgs->stroke_cache = NULL;
     pgs->have_pattern_streams = false;
     pgs->devicergb_cs = gs_cspace_new_DeviceRGB(mem);
     pgs->devicecmyk_cs = gs_cspace_new_DeviceCMYK(mem);
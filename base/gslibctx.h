@@ -98,6 +98,9 @@ typedef struct gs_lib_ctx_s
     char *default_device_list;
     int gcsignal;
     int scanconverter;
+    /* Decoded size (bytes) from which DCTDecode runs on its own thread, */
+    /* 0 to disable.  See the MinThreadedDecodeSize user parameter. */
+    long min_threaded_decode;
     void *sjpxd_private; /* optional for use of jpx codec */
 } gs_lib_ctx_t;
 
@@ -16,6 +16,7 @@
 
 /* Runs of RasterOps */
 #include "std.h"
+#include "memory_.h"
 #include "stdpre.h"
 #include "gsropt.h"
 #include "gp.h"
@@ -1366,6 +1367,122 @@ static void generic_rop_run24_const_st_trans(rop_run_op *op, byte *d, int len)
 }
 #endif
 
+#ifdef HAVE_SSE2
+/* For byte aligned depths without 1-bit operands, a rop is just a bitwise
+ * function of the D, S and T byte streams, so we can do 16 bytes at a time
+ * whatever the rop is. The rop is evaluated as a tree of multiplexers: for
+ * each of the 4 (T,S) combinations the rop reduces to one of 0, D, ~D or 1,
+ * and we then select between those by S and then by T. Constant operands
+ * are replicated across the vector; at 24bpp the 3 byte pattern repeats
+ * every 3 vectors. */
+#include <emmintrin.h>
+
+static inline __m128i
+sse2_rop_eval(const __m128i *m0, const __m128i *mx, __m128i D, __m128i S, __m128i T)
+{
+    __m128i f0 = _mm_xor_si128(m0[0], _mm_and_si128(mx[0], D));
+    __m128i f1 = _mm_xor_si128(m0[1], _mm_and_si128(mx[1], D));
+    __m128i f2 = _mm_xor_si128(m0[2], _mm_and_si128(mx[2], D));
+    __m128i f3 = _mm_xor_si128(m0[3], _mm_and_si128(mx[3], D));
+    __m128i g0 = _mm_xor_si128(f0, _mm_and_si128(_mm_xor_si128(f0, f1), S));
+    __m128i g1 = _mm_xor_si128(f2, _mm_and_si128(_mm_xor_si128(f2, f3), S));
+
+    return _mm_xor_si128(g0, _mm_and_si128(_mm_xor_si128(g0, g1), T));
+}
+
+static void
+sse2_const_vectors(__m128i *v, rop_operand c, int depth)
+{
+    if (depth == 8) {
+        v[0] = v[1] = v[2] = _mm_set1_epi8((char)c);
+    } else {
+        byte pat[48];
+        int i;
+
+        for (i = 0; i < 48; i += 3) {
+            pat[i] = (byte)(c >> 16);
+            pat[i+1] = (byte)(c >> 8);
+            pat[i+2] = (byte)c;
+        }
+        v[0] = _mm_loadu_si128((const __m128i *)pat);
+        v[1] = _mm_loadu_si128((const __m128i *)(pat + 16));
+        v[2] = _mm_loadu_si128((const __m128i *)(pat + 32));
+    }
+}
+
+static void sse2_rop_run(rop_run_op *op, byte *d, int len)
+{
+    int rop = lop_rop(op->rop);
+    int bytes = len * (op->depth >> 3);
+    bool s_const = (op->flags & rop_s_constant) != 0;
+    bool t_const = (op->flags & rop_t_constant) != 0;
+    /* Transparency is only allowed at 8bpp, and constant transparent
+     * operands have been culled by rop_get_run_op. */
+    bool s_trans = !s_const && (op->rop & lop_S_transparent);
+    bool t_trans = !t_const && (op->rop & lop_T_transparent);
+    const byte *s = (s_const ? NULL : op->s.b.ptr);
+    const byte *t = (t_const ? NULL : op->t.b.ptr);
+    const __m128i ones = _mm_set1_epi8((char)0xFF);
+    __m128i m0[4], mx[4], sc[3], tc[3];
+    __m128i D, S, T, R;
+    byte dtmp[16], stmp[16], ttmp[16];
+    int phase = 0, k;
+
+    /* Rop bit (T<<2)|(S<<1)|D gives the result for that combination. */
+    for (k = 0; k < 4; k++) {
+        m0[k] = ((rop >> (2*k)) & 1 ? ones : _mm_setzero_si128());
+        mx[k] = (((rop >> (2*k)) ^ (rop >> (2*k+1))) & 1 ?
+                 ones : _mm_setzero_si128());
+    }
+    if (s_const)
+        sse2_const_vectors(sc, op->s.c, op->depth);
+    if (t_const)
+        sse2_const_vectors(tc, op->t.c, op->depth);
+
+    for (;;) {
+        byte *dp = d;
+        const byte *sp = s, *tp = t;
+
+        if (bytes < 16) {
+            /* Do the tail through a buffer, and only copy back what's ours. */
+            if (bytes <= 0)
+                break;
+            memcpy(dtmp, d, bytes);
+            dp = dtmp;
+            if (!s_const)
+                memcpy(stmp, s, bytes), sp = stmp;
+            if (!t_const)
+                memcpy(ttmp, t, bytes), tp = ttmp;
+        }
+        D = _mm_loadu_si128((const __m128i *)dp);
+        S = (s_const ? sc[phase] : _mm_loadu_si128((const __m128i *)sp));
+        T = (t_const ? tc[phase] : _mm_loadu_si128((const __m128i *)tp));
+        R = sse2_rop_eval(m0, mx, D, S, T);
+        if (s_trans | t_trans) {
+            __m128i keep = _mm_setzero_si128();
+
+            if (s_trans)
+                keep = _mm_cmpeq_epi8(S, ones);
+            if (t_trans)
+                keep = _mm_or_si128(keep, _mm_cmpeq_epi8(T, ones));
+            R = _mm_xor_si128(R, _mm_and_si128(_mm_xor_si128(R, D), keep));
+        }
+        _mm_storeu_si128((__m128i *)dp, R);
+        if (bytes < 16) {
+            memcpy(d, dtmp, bytes);
+            break;
+        }
+        d += 16;
+        if (!s_const)
+            s += 16;
+        if (!t_const)
+            t += 16;
+        phase = (phase == 2 ? 0 : phase + 1);
+        bytes -= 16;
+    }
+}
+#endif
+
 #ifdef RECORD_ROP_USAGE
 static void record_run(rop_run_op *op, byte *d, int len)
 {
@@ -1708,6 +1825,16 @@ retry:
         break;
     }
 
+#ifdef HAVE_SSE2
+    /* Any byte aligned rop without 1-bit operands can be done 16 bytes at
+     * a time. At 24bpp transparency works on whole pixels, so leave that
+     * to the templated code. */
+    if ((depth == 8 ||
+         (depth == 24 && !(op->rop & (lop_S_transparent | lop_T_transparent)))) &&
+        !(op->flags & (rop_s_1bit | rop_t_1bit)))
+        op->run = sse2_rop_run;
+#endif
+
     if (swap)
     {
         op->runswap = op->run;
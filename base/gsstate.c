@@ -30,6 +30,7 @@
 #include "gxcmap.h"
 #include "gxdevice.h"
 #include "gxpcache.h"
+#include "gxpaint.h"
 #include "gzht.h"
 #include "gzline.h"
 #include "gspath.h"
@@ -87,6 +88,10 @@ static void clip_stack_rc_adjust(gx_clip_stack_t *cs, int delta, client_name_t c
  *              pattern_cache, which is associated with the entire
  *                stack, is allocated when first needed, and currently
  *                is never freed;
+ *              stroke_cache, which is likewise associated with the
+ *                entire stack, is allocated (in non-GC memory) with
+ *                the first gstate, and is freed when that gstate is
+ *                finalized: saved and copied gstates only share it;
  *              view_clip, which is associated with the current
  *                save level (effectively, with the gstate sub-stack
  *                back to the save) and is managed specially;
@@ -202,6 +207,7 @@ gs_gstate_alloc(gs_memory_t * mem)
     pgs->root_font = NULL;
     pgs->show_gstate = NULL;
     pgs->device = NULL;
+    pgs->stroke_cache = NULL;
 
     /*
      * Just enough of the state is initialized at this point
@@ -211,6 +217,8 @@ gs_gstate_alloc(gs_memory_t * mem)
     code = gs_gstate_initialize(pgs, mem);
     if (code < 0)
         goto fail;
+    /* Strokes simply aren't cached if this fails. */
+    pgs->stroke_cache = gx_stroke_cache_alloc(mem->non_gc_memory, pgs);
 
     /* Finish initializing the color rendering state. */
 
@@ -375,6 +383,8 @@ gs_grestore_only(gs_gstate * pgs)
     sdata = saved->client_data;
     if (saved->pattern_cache == 0)
         saved->pattern_cache = pgs->pattern_cache;
+    if (saved->stroke_cache == 0)
+        saved->stroke_cache = pgs->stroke_cache;
     /* Swap back the client data pointers. */
     pgs->client_data = sdata;
     saved->client_data = pdata;
@@ -1295,6 +1305,13 @@ gs_gstate_finalize(const gs_memory_t *cmem,void *vptr)
 
     if (cmem == NULL)
         return;			/* place for breakpoint */
+    /* Only the gstate that gs_gstate_alloc made the stroke cache for */
+    /* frees it; the gstates that picked it up from that one (see */
+    /* gs_grestore_only and gs_gstate_copy_for) leave it alone. */
+    if (pgs->stroke_cache != 0 &&
+        gx_stroke_cache_owner(pgs->stroke_cache) == pgs)
+        gx_stroke_cache_free(pgs->stroke_cache);
+    pgs->stroke_cache = 0;
     gstate_free_contents(pgs);
 }
 
@@ -1383,6 +1400,7 @@ gstate_copy(gs_gstate * pto, const gs_gstate * pfrom,
     }
     {
         struct gx_pattern_cache_s *pcache = pto->pattern_cache;
+        struct gx_stroke_cache_s *scache = pto->stroke_cache;
         void *pdata = pto->client_data;
         gs_memory_t *mem = pto->memory;
         gs_gstate *saved = pto->saved;
@@ -1396,6 +1414,8 @@ gstate_copy(gs_gstate * pto, const gs_gstate * pfrom,
         pto->line_params.dash.pattern = pattern;
         if (pto->pattern_cache == 0)
             pto->pattern_cache = pcache;
+        if (pto->stroke_cache == 0)
+            pto->stroke_cache = scache;
         if (pfrom->client_data != 0) {
             /* We need to break 'const' here. */
             gstate_copy_client_data((gs_gstate *) pfrom, pdata,
@@ -39,6 +39,12 @@ typedef struct tifs_io_private_t
 {
     FILE *f;
     gx_device_printer *pdev;
+    /* Used instead of f by handles from tiff_to_memory. */
+    gs_memory_t *mem;
+    byte *data;
+    size_t size;	/* allocated */
+    size_t len;		/* written */
+    size_t pos;
 } tifs_io_private;
 
 /* libtiff i/o hooks */
@@ -169,6 +175,126 @@ tiff_from_filep(gx_device_printer *dev,  const char *name, FILE *filep, int big_
     return t;
 }
 
+/* libtiff i/o hooks for a handle that writes into a growable block of
+ * memory rather than a file. */
+static size_t
+gs_tifsMemReadProc(thandle_t fd, void* buf, size_t size)
+{
+    tifs_io_private *tiffio = (tifs_io_private *)fd;
+
+    if (tiffio->pos >= tiffio->len)
+        return 0;
+    if (size > tiffio->len - tiffio->pos)
+        size = tiffio->len - tiffio->pos;
+    memcpy(buf, tiffio->data + tiffio->pos, size);
+    tiffio->pos += size;
+    return size;
+}
+
+static size_t
+gs_tifsMemWriteProc(thandle_t fd, void* buf, size_t size)
+{
+    tifs_io_private *tiffio = (tifs_io_private *)fd;
+
+    if (tiffio->pos + size > tiffio->size) {
+        size_t new_size = max(tiffio->size * 2, tiffio->pos + size);
+        byte *new_data = gs_alloc_bytes(tiffio->mem, new_size, "gs_tifsMemWriteProc");
+
+        if (new_data == NULL)
+            return (size_t) -1;
+        if (tiffio->data) {
+            memcpy(new_data, tiffio->data, tiffio->len);
+            gs_free_object(tiffio->mem, tiffio->data, "gs_tifsMemWriteProc");
+        }
+        tiffio->data = new_data;
+        tiffio->size = new_size;
+    }
+    if (tiffio->pos > tiffio->len)
+        memset(tiffio->data + tiffio->len, 0, tiffio->pos - tiffio->len);
+    memcpy(tiffio->data + tiffio->pos, buf, size);
+    tiffio->pos += size;
+    if (tiffio->pos > tiffio->len)
+        tiffio->len = tiffio->pos;
+    return size;
+}
+
+static uint64_t
+gs_tifsMemSeekProc(thandle_t fd, uint64_t off, int whence)
+{
+    tifs_io_private *tiffio = (tifs_io_private *)fd;
+
+    switch (whence) {
+        case SEEK_CUR:
+            off += tiffio->pos;
+            break;
+        case SEEK_END:
+            off += tiffio->len;
+            break;
+    }
+    tiffio->pos = (size_t)off;
+    return off;
+}
+
+static int
+gs_tifsMemCloseProc(thandle_t fd)
+{
+    return 0;
+}
+
+static uint64_t
+gs_tifsMemSizeProc(thandle_t fd)
+{
+    tifs_io_private *tiffio = (tifs_io_private *)fd;
+
+    return tiffio->len;
+}
+
+/* Open a write-only TIFF whose output is kept in memory allocated from
+ * mem. This lets strips be compressed away from the file they end up in;
+ * see tiff_memory_data and tiff_memory_close. */
+TIFF *
+tiff_to_memory(gx_device_printer *dev, gs_memory_t *mem, int big_endian)
+{
+    TIFF *t;
+    tifs_io_private *tiffio;
+
+    tiffio = (tifs_io_private *)gs_alloc_bytes(mem, sizeof(tifs_io_private), "tiff_to_memory");
+    if (!tiffio) {
+        return NULL;
+    }
+    memset(tiffio, 0, sizeof(tifs_io_private));
+    tiffio->pdev = dev;
+    tiffio->mem = mem;
+
+    t = TIFFClientOpen(dev->dname, big_endian ? "wb" : "wl",
+        (thandle_t) tiffio, (TIFFReadWriteProc)gs_tifsMemReadProc,
+        (TIFFReadWriteProc)gs_tifsMemWriteProc, (TIFFSeekProc)gs_tifsMemSeekProc,
+        gs_tifsMemCloseProc, (TIFFSizeProc)gs_tifsMemSizeProc, gs_tifsDummyMapProc,
+        gs_tifsDummyUnmapProc);
+    if (t == NULL) {
+        gs_free_object(mem, tiffio->data, "tiff_to_memory");
+        gs_free_object(mem, tiffio, "tiff_to_memory");
+    }
+    return t;
+}
+
+/* The bytes written so far to a TIFF from tiff_to_memory. */
+const byte *
+tiff_memory_data(TIFF *t)
+{
+    return ((tifs_io_private *)TIFFClientdata(t))->data;
+}
+
+void
+tiff_memory_close(TIFF *t)
+{
+    tifs_io_private *tiffio = (tifs_io_private *)TIFFClientdata(t);
+
+    TIFFCleanup(t);
+    gs_free_object(tiffio->mem, tiffio->data, "tiff_memory_close");
+    gs_free_object(tiffio->mem, tiffio, "tiff_memory_close");
+}
+
 static void
 gs_tifsWarningHandlerEx(thandle_t client_data, const char* module, const char* fmt, va_list ap)
 {
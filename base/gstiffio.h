@@ -22,6 +22,12 @@
 
 TIFF *
 tiff_from_filep(gx_device_printer *dev,  const char *name, FILE *filep, int big_endian, bool usebigtiff);
+TIFF *
+tiff_to_memory(gx_device_printer *dev, gs_memory_t *mem, int big_endian);
+const byte *
+tiff_memory_data(TIFF *t);
+void
+tiff_memory_close(TIFF *t);
 void tiff_set_handlers (void);
 
 #endif /* gstiffio_INCLUDED */
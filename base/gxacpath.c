@@ -172,6 +172,7 @@ gx_cpath_accum_end(gx_device_cpath_accum * padev, gx_clip_path * pcpath)
     if (code < 0)
         return code;
     gx_cpath_init_local(&apath, padev->list_memory);
+    gx_clip_list_build_index(&padev->list, padev->list_memory);
     apath.rect_list->list = padev->list;
     if (padev->list.count == 0)
         apath.path.bbox.p.x = apath.path.bbox.p.y =
@@ -261,6 +261,17 @@ bool ptr_is_within_mem_clumps(const void *ptr, gs_ref_memory_t *mem);
   (((clp)->cp != 0 && ptr_is_in_clump(ptr, (clp)->cp)) ||\
    clump_locate_ptr(ptr, clp))
 
+/*
+ * Locate a clump as above, but without moving it to the root of the
+ * splay tree, so that several threads may search the same tree at once
+ * (used by the parallel relocation phase of the garbage collector).
+ */
+bool clump_find_ptr(const void *, clump_locator_t *);
+
+#define clump_find(ptr, clp)\
+  (((clp)->cp != 0 && ptr_is_in_clump(ptr, (clp)->cp)) ||\
+   clump_find_ptr(ptr, clp))
+
 /* Close up the current clump. */
 /* This is exported for save/restore and for the GC. */
 void alloc_close_clump(gs_ref_memory_t * mem);
@@ -544,4 +555,9 @@ clump_t *clump_splay_walk_bwd_init(clump_splay_walker *sw, const gs_ref_memory_t
  * Will return NULL at the end point. */
 clump_t *clump_splay_walk_bwd(clump_splay_walker *sw);
 
+/* Rebalance the clump splay tree, so that searches that don't
+ * splay (clump_find_ptr) take logarithmic time. The set of
+ * clumps and their order are unchanged. */
+void clump_splay_balance(gs_ref_memory_t *imem);
+
 #endif /* gxalloc_INCLUDED */
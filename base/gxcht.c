@@ -554,6 +554,11 @@ static SET_HT_COLORS_PROC(set_ht_colors_gt_4);
 
 static SET_COLOR_HT_PROC(set_color_ht_le_4);
 static SET_COLOR_HT_PROC(set_color_ht_gt_4);
+static bool colored_tile_check(gx_ht_colored_tile *pct, int depth,
+                               int special, gx_color_index plane_mask,
+                               int width, int height, uint raster, int nplanes,
+                               const gx_color_index *colors,
+                               const gx_const_strip_bitmap **sbits);
 
 /* Prepare to use a colored halftone, by loading the default cache. */
 static int
@@ -686,16 +691,36 @@ gx_dc_ht_colored_fill_rectangle(const gx_device_color * pdevc,
         fit_fill(dev, x, y, w, h);
         /* Check to make sure we still have a big rectangle. */
         if (w > lw || h > lh) {
-            tiles.data = (byte *)tbits;
+            /*
+             * Text and thin strokes come here one small rectangle at a
+             * time, all with the same color, so keep the tile (and its id,
+             * which lets a band list recognize it) in the halftone cache.
+             */
+            gx_ht_colored_tile *pct =
+                (set_color_ht == set_color_ht_le_4 && caches[0] != NULL &&
+                 raster * lh <= sizeof(caches[0]->colored.data) ?
+                 &caches[0]->colored : NULL);
+
             tiles.raster = raster;
             tiles.rep_width = tiles.size.x = lw;
             tiles.rep_height = tiles.size.y = lh;
-            tiles.id = gs_next_ids(pdht->rc.memory, 1);
             tiles.rep_shift = tiles.shift = 0;
             tiles.num_planes = 1;
-            set_color_ht((byte *)tbits, raster, 0, 0, lw, lh, depth,
-                         special, nplanes, pdevc->colors.colored.plane_mask,
-                         dev, &vp, colors, sbits);
+            if (pct != NULL &&
+                colored_tile_check(pct, depth, special,
+                                   pdevc->colors.colored.plane_mask,
+                                   lw, lh, raster, nplanes, colors, sbits)) {
+                tiles.data = (byte *)pct->data;
+                tiles.id = pct->id;
+            } else {
+                tiles.data = (pct != NULL ? (byte *)pct->data : (byte *)tbits);
+                tiles.id = gs_next_ids(pdht->rc.memory, 1);
+                set_color_ht(tiles.data, raster, 0, 0, lw, lh, depth,
+                             special, nplanes, pdevc->colors.colored.plane_mask,
+                             dev, &vp, colors, sbits);
+                if (pct != NULL)
+                    pct->id = tiles.id;
+            }
             if (no_rop)
                 return (*dev_proc(dev, strip_tile_rectangle)) (dev, &tiles,
                                                                x, y, w, h,
@@ -814,6 +839,49 @@ fit:				/* Now the tile will definitely fit. */
     return code;
 }
 
+/*
+ * Check whether the colored tile kept in a halftone cache was built from
+ * the given colors and plane tiles.  Plane tile ids change whenever their
+ * contents do, so they stand in for the bits.  If the tile doesn't match,
+ * record the new key and mark it invalid; the caller sets the id once it
+ * has rebuilt the tile.
+ */
+static bool
+colored_tile_check(gx_ht_colored_tile *pct, int depth, int special,
+                   gx_color_index plane_mask, int width, int height,
+                   uint raster, int nplanes, const gx_color_index *colors,
+                   const gx_const_strip_bitmap **sbits)
+{
+    bool match = pct->id != gx_no_bitmap_id &&
+        pct->depth == depth && pct->special == special &&
+        pct->plane_mask == plane_mask && pct->width == width &&
+        pct->height == height && pct->raster == raster;
+    int i;
+
+    for (i = 0; i < nplanes && i < 4; ++i)
+        if (pct->plane_ids[i] != sbits[i]->id) {
+            pct->plane_ids[i] = sbits[i]->id;
+            match = false;
+        }
+    /* Only the entries that set_color_ht_le_4 will look at are set. */
+    for (i = 0; i < 16; ++i)
+        if ((special > 0 ? i < 2 : !(i & ~plane_mask)) &&
+            pct->colors[i] != colors[i]) {
+            pct->colors[i] = colors[i];
+            match = false;
+        }
+    if (!match) {
+        pct->id = gx_no_bitmap_id;
+        pct->depth = depth;
+        pct->special = special;
+        pct->plane_mask = plane_mask;
+        pct->width = width;
+        pct->height = height;
+        pct->raster = raster;
+    }
+    return match;
+}
+
 /* ---------------- Color table setup ---------------- */
 
 /*
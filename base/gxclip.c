@@ -46,6 +46,7 @@ static dev_proc_strip_copy_rop2(clip_strip_copy_rop2);
 static dev_proc_get_clipping_box(clip_get_clipping_box);
 static dev_proc_get_bits_rectangle(clip_get_bits_rectangle);
 static dev_proc_fill_path(clip_fill_path);
+static dev_proc_fill_trapezoid(clip_fill_trapezoid);
 
 /* The device descriptor. */
 static const gx_device_clip gs_clip_device =
@@ -78,7 +79,7 @@ static const gx_device_clip gs_clip_device =
   clip_fill_path,
   gx_default_stroke_path,
   clip_fill_mask,
-  gx_default_fill_trapezoid,
+  clip_fill_trapezoid,
   gx_default_fill_parallelogram,
   gx_default_fill_triangle,
   gx_default_draw_thin_line,
@@ -213,7 +214,7 @@ gx_make_clip_device_in_heap(gx_device_clip * dev, const gx_clip_path *pcpath, gx
 #if defined(DEBUG) && !defined(GS_THREADSAFE)
 struct stats_clip_s {
     long
-         loops, out, in_y, in, in1, down, up, x, no_x;
+         loops, out, in_y, in, in1, down, up, x, no_x, indexed, skip;
 } stats_clip;
 
 static const uint clip_interval = 10000;
@@ -225,6 +226,123 @@ static const uint clip_interval = 10000;
 # define INCR_THEN(v, e) (e)
 #endif
 
+/*
+ * Enumerate the rectangles of the x,w,y,h argument that fall within
+ * the clipping region, for a list with an index (see gxcpath.h).  This
+ * does exactly what the loop in clip_enumerate_rest below does, but finds
+ * the first band by binary search rather than by walking the list from
+ * the cursor, and within each band skips the rectangles that lie entirely
+ * to the left or right of x..xe, which matters for the long, wide lists
+ * produced by text or map clipping paths.
+ */
+static int
+clip_enumerate_indexed(gx_device_clip * rdev,
+                       int x, int y, int xe, int ye,
+                       int (*process)(clip_callback_data_t * pccd,
+                                      int xc, int yc, int xec, int yec),
+                       clip_callback_data_t * pccd)
+{
+    const gx_clip_index_entry *index = rdev->list.index;
+    const int n = rdev->list.count + 2;
+    gx_clip_rect *rptr = rdev->current;
+    int lo, hi, i;
+    int yc;
+    int code;
+
+    INCR(indexed);
+    /* Find the first rectangle with y < ymax (see clip_enumerate_rest). */
+    i = rptr->pos;
+    if (y >= rptr->ymax)
+        lo = i + 1, hi = n - 1;
+    else
+        lo = 0, hi = i;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+
+        if (index[mid].rect->ymax > y)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    if (lo >= n || (yc = index[lo].rect->ymin) >= ye) {
+        INCR(out);
+        rdev->current = (lo < n ? index[lo].rect : rdev->list.tail);
+        return 0;
+    }
+    i = lo;
+    rptr = index[i].rect;
+    rdev->current = rptr;
+    if (yc < y)
+        yc = y;
+
+    do {
+        const int ymax = rptr->ymax;
+        const int band_end = index[i].band_end;
+        int yec = min(ymax, ye);
+
+        if_debug2m('Q', rdev->memory, "[Q]yc=%d yec=%d\n", yc, yec);
+        if (rptr->xmax <= x && band_end - i > 2) {
+            /* Skip to the first rectangle with xmax > x. */
+            lo = i + 1, hi = band_end;
+            while (lo < hi) {
+                int mid = (lo + hi) >> 1;
+
+                if (index[mid].rect->xmax > x)
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            INCR(skip);
+            i = lo;
+        }
+        while (i < band_end) {
+            int xc, xec;
+
+            rptr = index[i].rect;
+            if (rptr->xmin >= xe) {
+                /* The rest of the band lies to the right. */
+                i = band_end;
+                break;
+            }
+            xc = max(rptr->xmin, x);
+            xec = min(rptr->xmax, xe);
+            if (xec > xc) {
+                clip_rect_print('Q', "match", rptr);
+                if_debug2m('Q', rdev->memory, "[Q]xc=%d xec=%d\n", xc, xec);
+                INCR(x);
+#ifdef CHECK_VERTICAL_CLIPPING
+                if (xec - xc == pccd->w) {	/* full width */
+                    /* Look ahead for a vertical swath. */
+                    while (++i < n &&
+                           (rptr = index[i].rect)->ymin == yec &&
+                           rptr->ymax <= ye &&
+                           rptr->xmin <= x &&
+                           rptr->xmax >= xe
+                           )
+                        yec = rptr->ymax;
+                } else
+                    ++i;
+#else
+                ++i;
+#endif
+                if (rdev->list.transpose)
+                    code = process(pccd, yc, xc, yec, xec);
+                else
+                    code = process(pccd, xc, yc, xec, yec);
+                if (code < 0)
+                    return code;
+            } else {
+                INCR(no_x);
+                ++i;
+            }
+        }
+        if (i >= n)
+            return 0;
+        rptr = index[i].rect;
+    } while ((yc = rptr->ymin) < ye);
+    return 0;
+}
+
 /*
  * Enumerate the rectangles of the x,w,y,h argument that fall within
  * the clipping region.
@@ -252,8 +370,12 @@ clip_enumerate_rest(gx_device_clip * rdev,
                   "[q]   down=%ld up=%ld x=%ld no_x=%ld\n",
                   stats_clip.down, stats_clip.up, stats_clip.x,
                   stats_clip.no_x);
+        dmprintf2(rdev->memory, "[q]   indexed=%ld skip=%ld\n",
+                  stats_clip.indexed, stats_clip.skip);
     }
 #endif
+    if (rdev->list.index != 0)
+        return clip_enumerate_indexed(rdev, x, y, xe, ye, process, pccd);
     /*
      * Warp the cursor forward or backward to the first rectangle row
      * that could include a given y value.  Assumes rptr is set, and
@@ -584,6 +706,52 @@ clip_fill_rectangle(gx_device * dev, int x, int y, int w, int h,
     return dev_proc(rdev, fill_rectangle)(dev, x, y, w, h, color);
 }
 
+/*
+ * Fill a trapezoid.  Replaying a pattern clist draws the whole tile
+ * through a clipping device that usually covers only a small part of it,
+ * so discard the trapezoids (and the scan lines) that lie outside the
+ * outer clipping box before rasterizing them.  The scan line positions
+ * are computed from the edges, not from ybot, so narrowing the y range
+ * doesn't change the pixels that are painted.
+ */
+static int
+clip_fill_trapezoid(gx_device * dev, const gs_fixed_edge * left,
+                    const gs_fixed_edge * right, fixed ybot, fixed ytop,
+                    bool swap_axes, const gx_drawing_color * pdcolor,
+                    gs_logical_operation_t lop)
+{
+    gx_device_clip *rdev = (gx_device_clip *) dev;
+
+    if (!rdev->list.transpose) {
+        gs_fixed_rect box;
+        fixed bmin, bmax, emin, emax;
+
+        clip_get_clipping_box(dev, &box);
+        if (swap_axes) {
+            bmin = box.p.x, bmax = box.q.x;
+            emin = box.p.y, emax = box.q.y;
+        } else {
+            bmin = box.p.y, bmax = box.q.y;
+            emin = box.p.x, emax = box.q.x;
+        }
+        if (ybot < bmin)
+            ybot = bmin;
+        if (ytop > bmax)
+            ytop = bmax;
+        if (ybot >= ytop)
+            return 0;
+        /* The edges only bound the trapezoid where they span [ybot,ytop]. */
+        if (left->start.y <= ybot && left->end.y >= ytop &&
+            right->start.y <= ybot && right->end.y >= ytop) {
+            if (max(right->start.x, right->end.x) < emin - fixed_1 ||
+                min(left->start.x, left->end.x) > emax + fixed_1)
+                return 0;
+        }
+    }
+    return gx_default_fill_trapezoid(dev, left, right, ybot, ytop, swap_axes,
+                                     pdcolor, lop);
+}
+
 int
 clip_call_fill_rectangle_hl_color(clip_callback_data_t * pccd, int xc, int yc, 
                                   int xec, int yec)
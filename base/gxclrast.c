@@ -610,6 +610,7 @@ in:                             /* Initialize for a new page. */
         (*dev_proc(target, get_clipping_box))(target, &target_box);
     GS_STATE_INIT_VALUES_CLIST((&gs_gstate));
     code = gs_gstate_initialize(&gs_gstate, mem);
+    gs_gstate.stroke_cache = gx_stroke_cache_alloc(mem, NULL);
     /* Remove the ICC link cache and replace with the device link cache
        so that we share the cache across bands */
     rc_decrement(gs_gstate.icc_link_cache,"clist_playback_band");
@@ -2303,6 +2304,8 @@ idata:                  data_size = 0;
         gx_pattern_cache_free(gs_gstate.pattern_cache);
         gs_gstate.pattern_cache = NULL;
     }
+    gx_stroke_cache_free(gs_gstate.stroke_cache);
+    gs_gstate.stroke_cache = NULL;
     /* The imager state release will decrement the icc link cache.  To avoid
        race conditions lock the cache */
     gx_monitor_enter(cdev->icc_cache_cl->lock);
@@ -661,7 +661,7 @@ clist_get_bits_rectangle(gx_device *dev, const gs_int_rect * prect,
     }
     {
         gs_get_bits_params_t band_params;
-        uint raster = gx_device_raster(bdev, true);
+        uint raster;
 
         code = gdev_create_buf_device(cdev->buf_procs.create_buf_device,
                                       &bdev, cdev->target, y, &render_plane,
@@ -669,6 +669,17 @@ clist_get_bits_rectangle(gx_device *dev, const gs_int_rect * prect,
                                       &(crdev->color_usage_array[y/crdev->page_band_height]));
         if (code < 0)
             return code;
+        raster = gx_device_raster(bdev, true);
+        if (options & GB_PACKING_CHUNKY) {
+            /* Step by the raster the first piece was returned with,
+             * which differs from the device's for a narrow rectangle. */
+            int end_bit = ((options & GB_OFFSET_SPECIFIED ? params->x_offset : 0) +
+                           prect->q.x - prect->p.x) * dev->color_info.depth;
+
+            raster = (options & GB_RASTER_SPECIFIED ? params->raster :
+                      options & GB_ALIGN_STANDARD ? bitmap_raster(end_bit) :
+                      (end_bit + 7) >> 3);
+        }
         band_params = *params;
         while ((y += lines_rasterized) < end_y) {
             int i;
@@ -35,6 +35,8 @@ static void gx_clip_list_from_rectangle(gx_clip_list *, gs_fixed_rect *);
 
 /* Other structure types */
 public_st_clip_rect();
+public_st_clip_index_entry();
+public_st_clip_index_element();
 public_st_clip_list();
 public_st_clip_path();
 private_st_clip_rect_list();
@@ -113,7 +115,8 @@ static const gx_clip_list clip_list_empty = {
     0, /* xmin */
     0, /* xmax */
     0, /* count */
-    0  /* transpose = false */
+    0, /* transpose = false */
+    0  /* index */
 };
 
 /* ------ Clipping path memory management ------ */
@@ -1050,12 +1053,50 @@ gx_cpath_enum_notes(const gs_cpath_enum * penum)
     return sn_none;
 }
 
+/* Build the index of a clip list. */
+void
+gx_clip_list_build_index(gx_clip_list * clp, gs_memory_t * mem)
+{
+    gx_clip_index_entry *index;
+    gx_clip_rect *rp;
+    int n = clp->count + 2, i, band_start;
+
+    if (clp->index != 0 || clp->head == 0 ||
+        clp->count < clip_list_index_min_count)
+        return;
+    index = gs_alloc_struct_array(mem, n, gx_clip_index_entry,
+                                  &st_clip_index_element,
+                                  "gx_clip_list_build_index");
+    if (index == 0)
+        return;
+    for (i = 0, band_start = 0, rp = clp->head; rp != 0; ++i, rp = rp->next) {
+        if (i == n) {		/* count is wrong, don't index */
+            gs_free_object(mem, index, "gx_clip_list_build_index");
+            return;
+        }
+        if (i > 0 && rp->ymax != index[i - 1].rect->ymax) {
+            for (; band_start < i; ++band_start)
+                index[band_start].band_end = i;
+        }
+        index[i].rect = rp;
+        rp->pos = i;
+    }
+    if (i != n) {
+        gs_free_object(mem, index, "gx_clip_list_build_index");
+        return;
+    }
+    for (; band_start < n; ++band_start)
+        index[band_start].band_end = n;
+    clp->index = index;
+}
+
 /* Free a clip list. */
 void
 gx_clip_list_free(gx_clip_list * clp, gs_memory_t * mem)
 {
     gx_clip_rect *rp = clp->tail;
 
+    gs_free_object(mem, clp->index, "gx_clip_list_free(index)");
     while (rp != 0) {
         gx_clip_rect *prev = rp->prev;
 
@@ -1127,6 +1168,7 @@ gx_cpath_copy(const gx_clip_path * from, gx_clip_path * pcpath)
         l->tail = s;
     }
     l->count = from->rect_list->list.count;
+    gx_clip_list_build_index(l, from->rect_list->rc.memory);
     return 0;
 }
 
@@ -47,6 +47,7 @@ struct gx_clip_rect_s {
     int ymin, ymax;		/* ymax > ymin */
     int xmin, xmax;		/* xmax > xmin */
     byte to_visit;		/* bookkeeping for gs_clippath */
+    int pos;			/* position in list index, if any */
 };
 
 /* The descriptor is public only for gxacpath.c. */
@@ -56,6 +57,33 @@ extern_st(st_clip_rect);
     clip_rect_enum_ptrs, clip_rect_reloc_ptrs, next, prev)
 #define st_clip_rect_max_ptrs 2
 
+/*
+ * Long lists also carry an index: an array holding every rectangle of the
+ * list, including the head and tail, in list order.  Since ymax never
+ * decreases along the list, the first rectangle of the band containing a
+ * given Y value can be found by binary search; band_end gives the index
+ * of the first rectangle of the following band, so that a band can be
+ * searched in X or skipped entirely.  The index only holds pointers, so it
+ * remains valid when the rectangles are scaled in place, but it must be
+ * rebuilt (or discarded) if rectangles are added or removed.
+ */
+typedef struct gx_clip_index_entry_s {
+    gx_clip_rect *rect;
+    int band_end;
+} gx_clip_index_entry;
+
+#define public_st_clip_index_entry()	/* in gxcpath.c */\
+  gs_public_st_ptrs1(st_clip_index_entry, gx_clip_index_entry,\
+    "gx_clip_index_entry", clip_index_entry_enum_ptrs,\
+    clip_index_entry_reloc_ptrs, rect)
+#define public_st_clip_index_element()	/* in gxcpath.c */\
+  gs_public_st_element(st_clip_index_element, gx_clip_index_entry,\
+    "gx_clip_index_entry[]", clip_index_element_enum_ptrs,\
+    clip_index_element_reloc_ptrs, st_clip_index_entry)
+
+/* Don't bother indexing lists shorter than this. */
+#define clip_list_index_min_count 64
+
 /*
  * A clip list may consist either of a single rectangle,
  * with null head and tail, or a list of rectangles.  In the latter case,
@@ -76,12 +104,13 @@ struct gx_clip_list_s {
     int count;			/* # of rectangles not counting */
                                 /* head or tail */
     bool transpose;		/* Transpose x / y */
+    gx_clip_index_entry *index;	/* count + 2 entries, or 0 (see above) */
 };
 
 #define public_st_clip_list()	/* in gxcpath.c */\
-  gs_public_st_ptrs2(st_clip_list, gx_clip_list, "clip_list",\
-    clip_list_enum_ptrs, clip_list_reloc_ptrs, head, tail)
-#define st_clip_list_max_ptrs 2	/* head, tail */
+  gs_public_st_ptrs3(st_clip_list, gx_clip_list, "clip_list",\
+    clip_list_enum_ptrs, clip_list_reloc_ptrs, head, tail, index)
+#define st_clip_list_max_ptrs 3	/* head, tail, index */
 #define clip_list_is_rectangle(clp) ((clp)->count <= 1)
 
 /*
@@ -131,6 +160,12 @@ void gx_clip_list_init(gx_clip_list *);
 /* Free a clip list. */
 void gx_clip_list_free(gx_clip_list *, gs_memory_t *);
 
+/*
+ * Build the index of a completed clip list, if it is long enough to be
+ * worth it.  The index is optional, so failure to allocate it is ignored.
+ */
+void gx_clip_list_build_index(gx_clip_list *, gs_memory_t *);
+
 /* Set the outer box for a clipping path from its bounding box. */
 void gx_cpath_set_outer_box(gx_clip_path *);
 
@@ -2599,7 +2599,7 @@ static int downscaler_init_fn(void *arg_, gx_device *dev, gs_memory_t *memory, i
                                                  &buffer->orig_buffer);
         if (code < 0) {
             if (buffer->bdev)
-                dev_proc(dev, close_device)(dev);
+                dev_proc(buffer->bdev, close_device)(buffer->bdev);
             gs_free_object(memory, buffer, "downscaler process_page buffer");
             return code;
         }
@@ -2632,15 +2632,16 @@ static int downscaler_process_fn(void *arg_, gx_device *dev, gx_device *bdev, co
     code = dev_proc(bdev, get_bits_rectangle)(bdev, &in_rect, &params, NULL);
     if (code < 0)
         return code;
-    raster_in = params.raster;
+    /* GB_RETURN_POINTER leaves params.raster alone, so ask the device. */
+    raster_in = gx_device_raster(bdev, true);
     in_ptr = params.data[0];
 
     /* Where do we write it to? */
     if (buffer->bdev) {
-        code = dev_proc(bdev, get_bits_rectangle)(buffer->bdev, &out_rect, &params, NULL);
+        code = dev_proc(buffer->bdev, get_bits_rectangle)(buffer->bdev, &out_rect, &params, NULL);
         if (code < 0)
             return code;
-        raster_out = params.raster;
+        raster_out = gx_device_raster(buffer->bdev, true);
         out_ptr = params.data[0];
     } else {
         raster_out = raster_in;
@@ -2678,7 +2679,7 @@ downscaler_free_fn(void *arg_, gx_device *dev, gs_memory_t *memory, void *buffer
     arg->orig_options->free_buffer_fn(arg->orig_options->arg, dev, memory,
                                       buffer->orig_buffer);
     if (buffer->bdev)
-        dev_proc(dev, close_device)(dev);
+        dev_proc(buffer->bdev, close_device)(buffer->bdev);
     gs_free_object(memory, buffer, "downscaler process_page buffer");
 }
 
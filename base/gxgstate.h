@@ -336,6 +336,8 @@ struct gs_gstate_s {
     gx_clip_path *clip_path; 
     gx_clip_stack_t *clip_stack;  /* (LanguageLevel 3 only) */ 
     gx_clip_path *view_clip;	  /* (may be 0, or have rule = 0) */ 
+    struct gx_stroke_cache_s *stroke_cache; /* (Shared) by all gstates, */
+                                /* not traced, see gxpaint.h */
     
     /* Effective clip path cache */ 
     gs_id effective_clip_id;            /* (key) clip path id */ 
@@ -718,6 +718,7 @@ gx_ht_init_cache(const gs_memory_t *mem, gx_ht_cache * pcache, const gx_ht_order
     pcache->num_cached = num_cached;
     pcache->levels_per_tile = (size + num_cached - 1) / num_cached;
     pcache->tiles_fit = -1;
+    pcache->colored.id = gx_no_bitmap_id;
     memset(tbits, 0, pcache->bits_size);
     for (i = 0; i < num_cached; i++, tbits += tile_bytes) {
         register gx_ht_tile *bt = &pcache->ht_tiles[i];
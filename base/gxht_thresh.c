@@ -103,24 +103,28 @@ gx_ht_threshold_row_byte(byte *contone, byte *threshold_strip, int contone_strid
 #endif
 
 #ifndef HAVE_SSE2
-/* A simple case for use in the landscape mode. Could probably be coded up
-   faster */
+/* Threshold 8 contone values to one byte of halftone, MSB first.  A bit is
+   set where contone < thresh.  The outcome of each compare is close to
+   random for dithered data, so build the byte without branching. */
+static byte
+threshold_8_bit(const byte *contone_ptr, const byte *thresh_ptr)
+{
+    return (byte)(((contone_ptr[0] < thresh_ptr[0]) << 7) |
+                  ((contone_ptr[1] < thresh_ptr[1]) << 6) |
+                  ((contone_ptr[2] < thresh_ptr[2]) << 5) |
+                  ((contone_ptr[3] < thresh_ptr[3]) << 4) |
+                  ((contone_ptr[4] < thresh_ptr[4]) << 3) |
+                  ((contone_ptr[5] < thresh_ptr[5]) << 2) |
+                  ((contone_ptr[6] < thresh_ptr[6]) << 1) |
+                   (contone_ptr[7] < thresh_ptr[7]));
+}
+
+/* A simple case for use in the landscape mode. */
 static void
 threshold_16_bit(byte *contone_ptr, byte *thresh_ptr, byte *ht_data)
 {
-    int j;
-
-    for (j = 2; j > 0; j--) {
-        byte h = 0;
-        byte bit_init = 0x80;
-        do {
-            if (*contone_ptr++ < *thresh_ptr++) {
-                h |=  bit_init;
-            }
-            bit_init >>= 1;
-        } while (bit_init != 0);
-        *ht_data++ = h;
-    }
+    ht_data[0] = threshold_8_bit(contone_ptr, thresh_ptr);
+    ht_data[1] = threshold_8_bit(contone_ptr + 8, thresh_ptr + 8);
 }
 #else
 /* Note this function has strict data alignment needs */
@@ -194,8 +198,8 @@ gx_ht_threshold_row_bit_sub(byte *contone,  byte *threshold_strip,  int contone_
     byte *halftone_ptr;
     byte bit_init;
 
-    /* For the moment just do a very slow compare until we get
-       get this working.  This could use some serious optimization */
+    /* The left remainder is done a bit at a time, the aligned body
+       a byte at a time */
     width -= offset_bits;
     for (j = 0; j < num_rows; j++) {
         byte h;
@@ -225,22 +229,23 @@ gx_ht_threshold_row_bit_sub(byte *contone,  byte *threshold_strip,  int contone_
             if (offset_bits < 8)
                 *halftone_ptr++ = 0;
         }
-        /* Now get the rest, which will be 16 bit aligned. */
+        /* Now get the rest, which will be 16 bit aligned.  Whole bytes
+           first, then any partial byte at the right. */
         k = width;
         if (k > 0) {
-            do {
-                if (*contone_ptr++ > *thresh_ptr++) {
-                    h |=  bit_init;
-                }
-                bit_init >>= 1;
-                if (bit_init == 0) {
-                    bit_init = 0x80;
-                    *halftone_ptr++ = h;
-                    h = 0;
-                }
-                k--;
-            } while (k > 0);
-            if (bit_init != 0x80) {
+            for (; k >= 8; k -= 8) {
+                *halftone_ptr++ = threshold_8_bit(thresh_ptr, contone_ptr);
+                contone_ptr += 8;
+                thresh_ptr += 8;
+            }
+            if (k > 0) {
+                do {
+                    if (*contone_ptr++ > *thresh_ptr++) {
+                        h |=  bit_init;
+                    }
+                    bit_init >>= 1;
+                    k--;
+                } while (k > 0);
                 *halftone_ptr++ = h;
             }
             if ((width & 15) < 8)
@@ -299,8 +304,8 @@ gx_ht_threshold_row_bit(byte *contone,  byte *threshold_strip,  int contone_stri
     byte *halftone_ptr;
     byte bit_init;
 
-    /* For the moment just do a very slow compare until we get
-       get this working.  This could use some serious optimization */
+    /* The left remainder is done a bit at a time, the aligned body
+       a byte at a time */
     width -= offset_bits;
     for (j = 0; j < num_rows; j++) {
         byte h;
@@ -330,22 +335,23 @@ gx_ht_threshold_row_bit(byte *contone,  byte *threshold_strip,  int contone_stri
             if (offset_bits < 8)
                 *halftone_ptr++ = 0;
         }
-        /* Now get the rest, which will be 16 bit aligned. */
+        /* Now get the rest, which will be 16 bit aligned.  Whole bytes
+           first, then any partial byte at the right. */
         k = width;
         if (k > 0) {
-            do {
-                if (*contone_ptr++ < *thresh_ptr++) {
-                    h |=  bit_init;
-                }
-                bit_init >>= 1;
-                if (bit_init == 0) {
-                    bit_init = 0x80;
-                    *halftone_ptr++ = h;
-                    h = 0;
-                }
-                k--;
-            } while (k > 0);
-            if (bit_init != 0x80) {
+            for (; k >= 8; k -= 8) {
+                *halftone_ptr++ = threshold_8_bit(contone_ptr, thresh_ptr);
+                contone_ptr += 8;
+                thresh_ptr += 8;
+            }
+            if (k > 0) {
+                do {
+                    if (*contone_ptr++ < *thresh_ptr++) {
+                        h |=  bit_init;
+                    }
+                    bit_init >>= 1;
+                    k--;
+                } while (k > 0);
                 *halftone_ptr++ = h;
             }
             if ((width & 15) < 8)
@@ -1146,6 +1152,190 @@ gxht_thresh_planes(gx_image_enum *penum, fixed xrun,
     return 0;
 }
 
+/* Threshold one row of contone against a threshold row and pack the
+   result MSB first.  A bit is set where the contone is darker than the
+   threshold: below it, or above it for sub (see gxht_thresh_planes). */
+static void
+threshold_row_packed(const byte *contone, const byte *thresh, int width,
+                     byte *halftone, bool sub)
+{
+    int k = 0;
+    byte h = 0;
+    byte bit_init = 0x80;
+
+#ifdef HAVE_SSE2
+    for (; k + 16 <= width; k += 16) {
+        if (sub)
+            threshold_16_SSE_unaligned((byte *)thresh + k, (byte *)contone + k,
+                                       halftone + (k >> 3));
+        else
+            threshold_16_SSE_unaligned((byte *)contone + k, (byte *)thresh + k,
+                                       halftone + (k >> 3));
+    }
+#else
+    for (; k + 8 <= width; k += 8) {
+        if (sub)
+            halftone[k >> 3] = threshold_8_bit(thresh + k, contone + k);
+        else
+            halftone[k >> 3] = threshold_8_bit(contone + k, thresh + k);
+    }
+#endif
+    for (; k < width; k++) {
+        if (sub ? contone[k] > thresh[k] : contone[k] < thresh[k])
+            h |= bit_init;
+        bit_init >>= 1;
+        if (bit_init == 0) {
+            halftone[k >> 3] = h;
+            h = 0;
+            bit_init = 0x80;
+        }
+    }
+    if (bit_init != 0x80)
+        halftone[(width - 1) >> 3] = h;
+}
+
+/*
+ * Halftone planar 8 bit contone data, such as the output of a transparency
+ * group, with the threshold arrays and put it to a device with one bit per
+ * component.  The data must already be in the device's colors.  Return 1
+ * if the rows were put, 0 if the device or the halftone needs the general
+ * path.
+ */
+int
+gxht_thresh_put_planes(gx_device *dev, const gs_gstate *pgs, const byte *data,
+                       int planestride, int rowstride, int num_comp,
+                       int x, int y, int width, int height)
+{
+    const gx_device_color_info *pinfo = &dev->color_info;
+    bool is_planar_dev = dev->is_planar;
+    bool additive = pinfo->polarity == GX_CINFO_POLARITY_ADDITIVE;
+    int depth = pinfo->depth;
+    int ht_raster = bitmap_raster(width);
+    gx_color_index dev_white, dev_black;
+    gx_color_index colors[16];
+    bool sub[4];
+    byte *thresh_row, *halftone, *out = NULL;
+    int code = 0;
+    int j, k, i;
+
+    if (!gx_device_must_halftone(dev) || pgs->dev_ht == NULL ||
+        num_comp > 4 || num_comp != pinfo->num_components ||
+        pgs->dev_ht->num_comp != num_comp ||
+        pinfo->polarity == GX_CINFO_POLARITY_UNKNOWN ||
+        pinfo->max_gray != 1 || (num_comp > 1 && pinfo->max_color != 1) ||
+        width <= 0 || height <= 0)
+        return 0;
+    if (is_planar_dev ? depth != num_comp :
+        (depth < num_comp || depth > 8 || (depth & (depth - 1)) != 0))
+        return 0;
+    for (k = 0; k < num_comp; k++) {
+        gx_ht_order *d_order = &(pgs->dev_ht->components[k].corder);
+
+        if (!gx_transfer_is_monotonic(pgs, k) ||
+            gx_ht_construct_threshold(d_order, dev, pgs, k) < 0)
+            return 0;
+        sub[k] = d_order->threshold_inverted ||
+                 pinfo->polarity == GX_CINFO_POLARITY_SUBTRACTIVE;
+    }
+    if (num_comp > 1 && !is_planar_dev) {
+        /* Colors for each combination of component bits, first */
+        /* component in the high bit. */
+        for (i = 0; i < 1 << num_comp; i++) {
+            gx_color_value cv[4];
+
+            for (k = 0; k < num_comp; k++)
+                cv[k] = (((i >> (num_comp - 1 - k)) & 1) ^ additive) ?
+                        gx_max_color_value : 0;
+            colors[i] = dev_proc(dev, encode_color)(dev, cv);
+        }
+        out = gs_alloc_bytes(dev->memory, bitmap_raster(width * depth),
+                             "gxht_thresh_put_planes");
+        if (out == NULL)
+            return_error(gs_error_VMerror);
+    }
+    thresh_row = gs_alloc_bytes(dev->memory, width, "gxht_thresh_put_planes");
+    halftone = gs_alloc_bytes(dev->memory, ht_raster * num_comp,
+                              "gxht_thresh_put_planes");
+    if (thresh_row == NULL || halftone == NULL) {
+        code = gs_note_error(gs_error_VMerror);
+        goto done;
+    }
+    dev_white = gx_device_white(dev);
+    dev_black = gx_device_black(dev);
+    for (j = 0; j < height; j++) {
+        for (k = 0; k < num_comp; k++) {
+            const gx_ht_order *d_order = &(pgs->dev_ht->components[k].corder);
+            int thresh_width = d_order->width;
+            int thresh_height = d_order->full_height;
+            int dx, dy, left_width, num_full_tiles;
+
+            /* Tile the threshold row as gxht_thresh_planes does. */
+            dx = (x + pgs->screen_phase[0].x) % thresh_width;
+            if (dx < 0)
+                dx += thresh_width;
+            dy = (y + j - pgs->screen_phase[0].y) % thresh_height;
+            if (dy < 0)
+                dy += thresh_height;
+            left_width = min(dx + width, thresh_width) - dx;
+            num_full_tiles = (width - left_width) / thresh_width;
+            fill_threshold_buffer(thresh_row,
+                                  d_order->threshold + thresh_width * dy,
+                                  thresh_width, dx, left_width, num_full_tiles,
+                                  width - num_full_tiles * thresh_width -
+                                  left_width);
+            threshold_row_packed(data + k * planestride + j * rowstride,
+                                 thresh_row, width, halftone + k * ht_raster,
+                                 sub[k]);
+        }
+        if (num_comp == 1 && !is_planar_dev) {
+            code = (*dev_proc(dev, copy_mono))(dev, halftone, 0, ht_raster,
+                                               gx_no_bitmap_id, x, y + j,
+                                               width, 1, dev_white, dev_black);
+        } else if (is_planar_dev) {
+            /* A set bit is a dark pixel; an additive plane wants light. */
+            if (additive)
+                for (i = 0; i < ht_raster * num_comp; i++)
+                    halftone[i] = ~halftone[i];
+            code = (*dev_proc(dev, copy_planes))(dev, halftone, 0, ht_raster,
+                                                 gx_no_bitmap_id, x, y + j,
+                                                 width, 1, 1);
+        } else {
+            byte *q = out;
+            byte acc = 0;
+            int shift = 8 - depth;
+
+            for (i = 0; i < width; i++) {
+                int mask = 0x80 >> (i & 7);
+                int index = 0;
+
+                for (k = 0; k < num_comp; k++)
+                    index = (index << 1) |
+                            ((halftone[k * ht_raster + (i >> 3)] & mask) != 0);
+                acc |= (byte)(colors[index] << shift);
+                shift -= depth;
+                if (shift < 0) {
+                    *q++ = acc;
+                    acc = 0;
+                    shift = 8 - depth;
+                }
+            }
+            if (shift != 8 - depth)
+                *q = acc;
+            code = (*dev_proc(dev, copy_color))(dev, out, 0,
+                                                bitmap_raster(width * depth),
+                                                gx_no_bitmap_id, x, y + j,
+                                                width, 1);
+        }
+        if (code < 0)
+            break;
+    }
+done:
+    gs_free_object(dev->memory, halftone, "gxht_thresh_put_planes");
+    gs_free_object(dev->memory, thresh_row, "gxht_thresh_put_planes");
+    gs_free_object(dev->memory, out, "gxht_thresh_put_planes");
+    return code < 0 ? code : 1;
+}
+
 int gxht_dda_length(gx_dda_fixed *dda, int src_size)
 {
     gx_dda_fixed d = (*dda);
@@ -47,6 +47,9 @@ int gxht_thresh_image_init(gx_image_enum *penum);
 int gxht_thresh_planes(gx_image_enum *penum, fixed xrun, int dest_width,
                        int dest_height, byte *thresh_align, gx_device * dev,
                        int offset_contone[], int contone_stride);
+int gxht_thresh_put_planes(gx_device *dev, const gs_gstate *pgs,
+                           const byte *data, int planestride, int rowstride,
+                           int num_comp, int x, int y, int width, int height);
 
 /* Helper function for an operation performed several times */
 int gxht_dda_length(gx_dda_fixed *dda, int src_size);
@@ -118,4 +118,24 @@ int gx_stroke_path_only(gx_path * ppath, gx_path * to_path, gx_device * dev,
                         const gx_device_color * pdevc,
                         const gx_clip_path * pcpath);
 
+/*
+ * Define the cache of stroke outlines.  Repeated strokes of the same path
+ * shape with the same line parameters and CTM (except for translation)
+ * replay the outline built the first time instead of recomputing joins
+ * and caps.  The cache is shared by all the gstates derived from one
+ * gs_gstate_alloc, like the pattern cache.  It is allocated in non-GC
+ * memory and isn't traced.  The owner is the gstate that is to free it
+ * (see gs_gstate_finalize), or 0 if the caller frees it explicitly;
+ * the garbage collector moves the owner along with the gstate.
+ */
+#ifndef gx_stroke_cache_DEFINED
+#  define gx_stroke_cache_DEFINED
+typedef struct gx_stroke_cache_s gx_stroke_cache;
+#endif
+
+gx_stroke_cache *gx_stroke_cache_alloc(gs_memory_t *mem, const void *owner);
+const void *gx_stroke_cache_owner(const gx_stroke_cache *pcache);
+void gx_stroke_cache_set_owner(gx_stroke_cache *pcache, const void *owner);
+void gx_stroke_cache_free(gx_stroke_cache *pcache);
+
 #endif /* gxpaint_INCLUDED */
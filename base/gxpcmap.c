@@ -79,6 +79,28 @@ gx_pat_cache_default_bits(void)
 #endif
 }
 
+/* The PostScript interpreter has a single Pattern cache for each context, */
+/* so it can afford room for a few tiles of the largest size that is kept */
+/* as a bitmap (see gx_pattern_accum_alloc): pages alternating between */
+/* several big patterns then don't re-render each tile on every use.  The */
+/* other caches, such as the one in each clist rendering thread, keep the */
+/* default size above.  This is the initial MaxPatternCache system parameter. */
+#define max_pattern_bits_interp_LARGE (4 * MaxPatternBitmap_DEFAULT)
+ulong
+gx_pat_cache_interp_bits(void)
+{
+#if ARCH_SMALL_MEMORY
+    return max_pattern_bits_SMALL;
+#else
+#ifdef DEBUG
+    return (gs_debug_c('.') ? max_pattern_bits_SMALL :
+            max_pattern_bits_interp_LARGE);
+#else
+    return max_pattern_bits_interp_LARGE;
+#endif
+#endif
+}
+
 /* Define the structures for Pattern rendering and caching. */
 private_st_color_tile();
 private_st_color_tile_element();
@@ -253,6 +253,7 @@ struct gx_color_tile_s {
 /* truncate names to 23 characters. */
 uint gx_pat_cache_default_tiles(void);
 ulong gx_pat_cache_default_bits(void);
+ulong gx_pat_cache_interp_bits(void);
 gx_pattern_cache *gx_pattern_alloc_cache(gs_memory_t *, uint, ulong);
 /* Free pattern cache and its components. */
 void gx_pattern_cache_free(gx_pattern_cache *pcache);
@@ -3025,6 +3025,20 @@ static int
 mesh_triangle_rec(patch_fill_state_t *pfs,
         const shading_vertex_t *p0, const shading_vertex_t *p1, const shading_vertex_t *p2)
 {
+    if (!pfs->inside) {
+        /* Skip triangles outside the clipping box (e.g. outside the band)
+           before subdividing them, as fill_patch does for patches. */
+        gs_fixed_rect r;
+
+        bbox_of_points(&r, &p0->p, &p1->p, &p2->p, NULL);
+        r.p.x -= INTERPATCH_PADDING;
+        r.p.y -= INTERPATCH_PADDING;
+        r.q.x += INTERPATCH_PADDING;
+        r.q.y += INTERPATCH_PADDING;
+        rect_intersect(r, pfs->rect);
+        if (r.q.x <= r.p.x || r.q.y <= r.p.y)
+            return 0;
+    }
     pfs->unlinear = !is_linear_color_applicable(pfs);
     if (manhattan_dist(&p0->p, &p1->p) < pfs->max_small_coord &&
         manhattan_dist(&p1->p, &p2->p) < pfs->max_small_coord &&
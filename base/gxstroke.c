@@ -16,6 +16,7 @@
 
 /* Path stroking procedures for Ghostscript library */
 #include "math_.h"
+#include "memory_.h"
 #include <stdlib.h> /* abs() */
 #include "gx.h"
 #include "gpcheck.h"
@@ -324,6 +325,28 @@ static int cap_points(gs_line_cap, const_ep_ptr,
                        gs_fixed_point * /*[3] */ );
 static int join_under_pie(gx_path *, pl_ptr, pl_ptr, bool);
 
+/*
+ * Define the record of the fill outlines made while stroking a path,
+ * used to fill the stroke cache (see below).  The outline is recorded
+ * only if the whole stroke is painted by filling outline pieces, and not
+ * partly by drawing thin lines or parallelograms directly.
+ */
+#define STROKE_CACHE_MAX_PIECES 256
+typedef struct stroke_outline_record_s {
+    gs_memory_t *memory;
+    bool ok;
+    bool always_thin;
+    int count;
+    gx_path *pieces[STROKE_CACHE_MAX_PIECES];
+} stroke_outline_record;
+
+static void stroke_record_piece(stroke_outline_record *, const gx_path *);
+static int gx_stroke_path_only_aux(gx_path *, gx_path *, gx_device *,
+                                   const gs_gstate *, const gx_stroke_params *,
+                                   const gx_device_color *,
+                                   const gx_clip_path *,
+                                   stroke_outline_record *);
+
 /* Define the default implementation of the device stroke_path procedure. */
 int
 gx_default_stroke_path(gx_device * dev, const gs_gstate * pgs,
@@ -337,7 +360,7 @@ gx_default_stroke_path(gx_device * dev, const gs_gstate * pgs,
 
 /* Fill a partial stroked path.  Free variables: */
 /* to_path, stroke_path_body, fill_params, always_thin, pgs, dev, pdevc, */
-/* code, ppath, exit(label). */
+/* code, ppath, rec, exit(label). */
 #define FILL_STROKE_PATH(dev, thin, pcpath, final)\
   if(to_path==&stroke_path_body && !gx_path_is_void(&stroke_path_body) &&\
      (final || lop_is_idempotent(pgs->log_op))) {\
@@ -347,6 +370,8 @@ gx_default_stroke_path(gx_device * dev, const gs_gstate * pgs,
         code = gx_join_path_and_reverse(to_path, to_path_reverse);\
         if(code < 0) goto exit;\
     }\
+    if (rec != NULL && rec->ok)\
+        stroke_record_piece(rec, to_path);\
     code = gx_fill_path_only(to_path, dev, pgs, &fill_params, pdevc, pcpath);\
     gx_path_free(&stroke_path_body, "fill_stroke_path");\
     if ( code < 0 ) goto exit;\
@@ -419,7 +444,8 @@ gx_join_path_and_reverse(gx_path * path, gx_path * rpath)
 static int
 gx_stroke_path_only_aux(gx_path * ppath, gx_path * to_path, gx_device * pdev,
                const gs_gstate * pgs, const gx_stroke_params * params,
-                 const gx_device_color * pdevc, const gx_clip_path * pcpath)
+                 const gx_device_color * pdevc, const gx_clip_path * pcpath,
+                 stroke_outline_record * rec)
 {
     bool CPSI_mode = gs_currentcpsimode(pgs->memory);
     bool traditional = CPSI_mode | params->traditional;
@@ -644,6 +670,8 @@ gx_stroke_path_only_aux(gx_path * ppath, gx_path * to_path, gx_device * pdev,
     }
     if_debug7m('o', ppath->memory, "[o]ctm=(%g,%g,%g,%g,%g,%g) thin=%d\n",
               xx, xy, yx, yy, pgs->ctm.tx, pgs->ctm.ty, always_thin);
+    if (rec != NULL)
+        rec->always_thin = always_thin;
     if (device_dot_length != 0) {
         /*
          * Compute the dot length in device space.  We can't do this
@@ -997,6 +1025,9 @@ gx_stroke_path_only_aux(gx_path * ppath, gx_path * to_path, gx_device * pdev,
                                      COMBINE_FLAGS(flags));
                 if (code < 0)
                     goto exit;
+                /* stroke_fill leaves the path void if it drew directly. */
+                if (rec != NULL && gx_path_is_void(to_path))
+                    rec->ok = false;
                 FILL_STROKE_PATH(pdev, always_thin, pcpath, false);
             } else if (pseg->type == s_gap) {
                 /* If this segment is a gap, then we don't want to draw it
@@ -1042,6 +1073,8 @@ gx_stroke_path_only_aux(gx_path * ppath, gx_path * to_path, gx_device * pdev,
                                  COMBINE_FLAGS(flags));
             if (code < 0)
                 goto exit;
+            if (rec != NULL && gx_path_is_void(to_path))
+                rec->ok = false;
             FILL_STROKE_PATH(pdev, always_thin, pcpath, false);
             cap = ((flags & nf_prev_dash_head) ?
                    pgs_lp->start_cap : pgs_lp->dash_cap);
@@ -1073,12 +1106,456 @@ gx_stroke_path_only_aux(gx_path * ppath, gx_path * to_path, gx_device * pdev,
     return code;
 }
 
+/* ------ Stroke outline cache ------ */
+
+/*
+ * The outline of a stroke depends only on the shape of the path, the line
+ * parameters (including the dash pattern) and the CTM without its
+ * translation: translating the path by a whole number of fixed units
+ * translates the outline by the same amount, since dashes are laid out
+ * from coordinate differences.  Subdividing curves and stroke adjustment
+ * both round to the pixel grid, so for paths with curves or with stroke
+ * adjustment we also require the same position within a pixel.
+ *
+ * Stroke adjustment also looks at the last segment of the previous stroke
+ * (dev->sgr, see adjust_stroke) to recognize gradients drawn as parallel
+ * strokes.  We record with a neutral state, and don't use the cache when
+ * the segment left by the previous stroke could touch the path; the state
+ * a stroke leaves is recorded along with the outline and restored when it
+ * is replayed.
+ *
+ * A shape is recorded the second time it is seen, so that paths stroked
+ * only once cost no more than computing a hash.
+ */
+#define STROKE_CACHE_SIZE 64            /* must be a power of 2 */
+#define STROKE_CACHE_MAX_SEGMENTS 200   /* don't cache longer paths */
+#define STROKE_CACHE_MAX_DASHES 16      /* don't cache longer dash patterns */
+
+typedef struct stroke_cache_key_s {
+    float xx, xy, yx, yy;               /* CTM without translation */
+    gs_matrix initial_matrix;           /* of the device */
+    float half_width;
+    gs_line_cap start_cap, end_cap, dash_cap;
+    gs_line_join join;
+    int curve_join;
+    float miter_limit, miter_check;
+    float dot_length;
+    bool dot_length_absolute;
+    gs_matrix dot_orientation;
+    float flatness, stroke_flatness;
+    gs_fixed_point fill_adjust;
+    bool traditional;
+    bool accurate_curves;
+    gs_logical_operation_t log_op;
+    bool stroke_adjust;
+    uint dash_size;
+    float dash_pattern[STROKE_CACHE_MAX_DASHES];
+    float dash_offset;
+    bool dash_adapt;
+    bool dash_init_ink_on;
+    int dash_init_index;
+    float dash_init_dist_left;
+    gs_fixed_point phase;               /* only for curves or stroke adjust */
+} stroke_cache_key_t;
+
+typedef struct stroke_cache_entry_s {
+    ulong hash;                 /* hash of the recorded shape */
+    stroke_cache_key_t key;
+    gx_path *path;              /* the stroked path, 0 if none recorded */
+    bool always_thin;
+    int count;
+    gx_path **pieces;           /* [count] outline pieces, each filled */
+                                /* separately as when stroking */
+    gs_fixed_point offset;      /* translation of pieces from path, */
+                                /* left from the last replay */
+    bool sgr_set;               /* stroking sets dev->sgr to sgr */
+    gx_stroked_gradient_recognizer_t sgr;       /* relative to path */
+} stroke_cache_entry_t;
+
+struct gx_stroke_cache_s {
+    gs_memory_t *memory;
+    const void *owner;
+    stroke_cache_entry_t entries[STROKE_CACHE_SIZE];
+    ulong seen[STROKE_CACHE_SIZE];      /* hashes of shapes seen once */
+};
+
+gx_stroke_cache *
+gx_stroke_cache_alloc(gs_memory_t *mem, const void *owner)
+{
+    gx_stroke_cache *pcache = (gx_stroke_cache *)
+        gs_alloc_bytes(mem, sizeof(gx_stroke_cache), "gx_stroke_cache_alloc");
+
+    if (pcache == NULL)
+        return NULL;
+    memset(pcache, 0, sizeof(*pcache));
+    pcache->memory = mem;
+    pcache->owner = owner;
+    return pcache;
+}
+
+const void *
+gx_stroke_cache_owner(const gx_stroke_cache *pcache)
+{
+    return pcache->owner;
+}
+
+void
+gx_stroke_cache_set_owner(gx_stroke_cache *pcache, const void *owner)
+{
+    pcache->owner = owner;
+}
+
+static void
+stroke_free_pieces(gx_path **pieces, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        gx_path_free(pieces[i], "stroke_free_pieces");
+}
+
+static void
+stroke_cache_free_entry(gx_stroke_cache *pcache, stroke_cache_entry_t *pe)
+{
+    if (pe->path == NULL)
+        return;
+    stroke_free_pieces(pe->pieces, pe->count);
+    gs_free_object(pcache->memory, pe->pieces, "stroke_cache_free_entry");
+    gx_path_free(pe->path, "stroke_cache_free_entry");
+    pe->path = NULL;
+    pe->pieces = NULL;
+    pe->count = 0;
+}
+
+void
+gx_stroke_cache_free(gx_stroke_cache *pcache)
+{
+    int i;
+
+    if (pcache == NULL)
+        return;
+    for (i = 0; i < STROKE_CACHE_SIZE; i++)
+        stroke_cache_free_entry(pcache, &pcache->entries[i]);
+    gs_free_object(pcache->memory, pcache, "gx_stroke_cache_free");
+}
+
+/* Add a copy of an outline piece to a record. */
+static void
+stroke_record_piece(stroke_outline_record *rec, const gx_path *ppath)
+{
+    gx_path *piece;
+
+    if (rec->count == STROKE_CACHE_MAX_PIECES ||
+        gx_path_has_long_segments(ppath)) {
+        rec->ok = false;
+        return;
+    }
+    piece = gx_path_alloc(rec->memory, "stroke_record_piece");
+    if (piece == NULL) {
+        rec->ok = false;
+        return;
+    }
+    if (gx_path_copy(ppath, piece) < 0) {
+        gx_path_free(piece, "stroke_record_piece");
+        rec->ok = false;
+        return;
+    }
+    rec->pieces[rec->count++] = piece;
+}
+
+/*
+ * Compute the cache key for stroking a path.  Return false if the stroke
+ * can't be cached.
+ */
+static bool
+stroke_cache_make_key(const gx_path *ppath, gx_device *pdev,
+                      const gs_gstate *pgs, const gx_stroke_params *params,
+                      stroke_cache_key_t *pkey)
+{
+    const gx_line_params *pgs_lp = gs_currentlineparams_inline(pgs);
+
+    if (pgs_lp->dash.pattern_size > STROKE_CACHE_MAX_DASHES ||
+        !lop_is_idempotent(pgs->log_op) || ppath->first_subpath == NULL ||
+        gx_path_has_long_segments(ppath))
+        return false;
+    memset(pkey, 0, sizeof(*pkey));
+    pkey->xx = pgs->ctm.xx, pkey->xy = pgs->ctm.xy;
+    pkey->yx = pgs->ctm.yx, pkey->yy = pgs->ctm.yy;
+    (*dev_proc(pdev, get_initial_matrix)) (pdev, &pkey->initial_matrix);
+    pkey->half_width = pgs_lp->half_width;
+    pkey->start_cap = pgs_lp->start_cap;
+    pkey->end_cap = pgs_lp->end_cap;
+    pkey->dash_cap = pgs_lp->dash_cap;
+    pkey->join = pgs_lp->join;
+    pkey->curve_join = pgs_lp->curve_join;
+    pkey->miter_limit = pgs_lp->miter_limit;
+    pkey->miter_check = pgs_lp->miter_check;
+    pkey->dot_length = pgs_lp->dot_length;
+    pkey->dot_length_absolute = pgs_lp->dot_length_absolute;
+    pkey->dot_orientation = pgs_lp->dot_orientation;
+    pkey->flatness = pgs->flatness;
+    pkey->stroke_flatness = params->flatness;
+    pkey->fill_adjust = pgs->fill_adjust;
+    pkey->traditional = gs_currentcpsimode(pgs->memory) | params->traditional;
+    pkey->accurate_curves = pgs->accurate_curves;
+    pkey->log_op = pgs->log_op;
+    pkey->stroke_adjust = pgs->stroke_adjust;
+    pkey->dash_size = pgs_lp->dash.pattern_size;
+    if (pkey->dash_size != 0) {
+        memcpy(pkey->dash_pattern, pgs_lp->dash.pattern,
+               pkey->dash_size * sizeof(float));
+        pkey->dash_offset = pgs_lp->dash.offset;
+        pkey->dash_adapt = pgs_lp->dash.adapt;
+        pkey->dash_init_ink_on = pgs_lp->dash.init_ink_on;
+        pkey->dash_init_index = pgs_lp->dash.init_index;
+        pkey->dash_init_dist_left = pgs_lp->dash.init_dist_left;
+    }
+    if (pgs->stroke_adjust || gx_path_has_curves(ppath)) {
+        pkey->phase.x = fixed_fraction(ppath->first_subpath->pt.x);
+        pkey->phase.y = fixed_fraction(ppath->first_subpath->pt.y);
+    }
+    return true;
+}
+
+/*
+ * Hash a key and the shape of a path, relative to its first point.
+ * Return 0 if the path is too long to cache.
+ */
+static ulong
+stroke_cache_hash(const stroke_cache_key_t *pkey, const gx_path *ppath)
+{
+    const byte *p = (const byte *)pkey;
+    const segment *pseg = (const segment *)ppath->first_subpath;
+    fixed x0 = pseg->pt.x, y0 = pseg->pt.y;
+    ulong hash = 0;
+    uint i;
+    int count = 0;
+
+#define HASH(v) (hash = hash * 31 + (ulong)(v))
+    for (i = 0; i < sizeof(*pkey); i++)
+        HASH(p[i]);
+    for (; pseg != 0; pseg = pseg->next) {
+        if (++count > STROKE_CACHE_MAX_SEGMENTS)
+            return 0;
+        HASH(pseg->type);
+        HASH(pseg->notes);
+        if (pseg->type == s_start)
+            HASH(((const subpath *)pseg)->is_closed);
+        else if (pseg->type == s_curve) {
+            const curve_segment *pc = (const curve_segment *)pseg;
+
+            HASH(pc->p1.x - x0), HASH(pc->p1.y - y0);
+            HASH(pc->p2.x - x0), HASH(pc->p2.y - y0);
+        }
+        HASH(pseg->pt.x - x0), HASH(pseg->pt.y - y0);
+    }
+#undef HASH
+    /* Mix the high bits into the low ones, which choose the slot. */
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6d;
+    hash ^= hash >> 12;
+    return (hash == 0 ? 1 : hash);
+}
+
+/* Check whether ppath is the path recorded in pe translated by (dx,dy). */
+static bool
+stroke_cache_same_path(const gx_path *ppath, const stroke_cache_entry_t *pe,
+                       fixed dx, fixed dy)
+{
+    const segment *pseg = (const segment *)ppath->first_subpath;
+    const segment *prec = (const segment *)pe->path->first_subpath;
+
+    for (; pseg != 0 && prec != 0; pseg = pseg->next, prec = prec->next) {
+        if (pseg->type != prec->type || pseg->notes != prec->notes ||
+            pseg->pt.x != prec->pt.x + dx || pseg->pt.y != prec->pt.y + dy)
+            return false;
+        if (pseg->type == s_start) {
+            if (((const subpath *)pseg)->is_closed !=
+                ((const subpath *)prec)->is_closed)
+                return false;
+        } else if (pseg->type == s_curve) {
+            const curve_segment *pc = (const curve_segment *)pseg;
+            const curve_segment *prc = (const curve_segment *)prec;
+
+            if (pc->p1.x != prc->p1.x + dx || pc->p1.y != prc->p1.y + dy ||
+                pc->p2.x != prc->p2.x + dx || pc->p2.y != prc->p2.y + dy)
+                return false;
+        }
+    }
+    return pseg == prec;
+}
+
+/*
+ * Check whether the last segment of the previous stroke, as remembered for
+ * stroke adjustment, could touch the path, so that stroking the path might
+ * depend on it (see adjust_stroke).
+ */
+static bool
+stroke_cache_sgr_may_touch(gx_path *ppath, const gx_device *pdev,
+                           const gs_gstate *pgs)
+{
+    const gx_line_params *pgs_lp = gs_currentlineparams_inline(pgs);
+    const gx_stroked_gradient_recognizer_t *psgr = &pdev->sgr;
+    gs_fixed_rect bbox;
+    double width;
+    int64_t rx, ry;
+    int i;
+
+    if (!pgs->stroke_adjust || !psgr->stroke_stored ||
+        (pgs_lp->start_cap != gs_cap_butt && pgs_lp->end_cap != gs_cap_butt &&
+         pgs_lp->dash_cap != gs_cap_butt))
+        return false;
+    if (gx_path_bbox(ppath, &bbox) < 0)
+        return true;
+    /* Bound the device space width of the segments of this stroke. */
+    width = fabs(pgs_lp->half_width) * 2 *
+        (fabs(pgs->ctm.xx) + fabs(pgs->ctm.xy) +
+         fabs(pgs->ctm.yx) + fabs(pgs->ctm.yy));
+    if (width > fixed2float(max_fixed) / 4)
+        return true;
+    rx = (int64_t)any_abs(psgr->orig[2].x) + float2fixed(width) + 2 * fixed_1;
+    ry = (int64_t)any_abs(psgr->orig[2].y) + float2fixed(width) + 2 * fixed_1;
+    for (i = 0; i < 2; i++) {
+        const gs_fixed_point *pt = &psgr->orig[i];
+
+        if ((int64_t)bbox.p.x - pt->x > rx || (int64_t)pt->x - bbox.q.x > rx ||
+            (int64_t)bbox.p.y - pt->y > ry || (int64_t)pt->y - bbox.q.y > ry)
+            return false;
+    }
+    return true;
+}
+
+/* Fill the recorded outline pieces, translated by (dx,dy) from the path. */
+static int
+stroke_cache_replay(stroke_cache_entry_t *pe, fixed dx, fixed dy,
+                    gx_device *pdev, const gs_gstate *pgs,
+                    const gx_device_color *pdevc, const gx_clip_path *pcpath)
+{
+    gx_fill_params fill_params;
+    fixed tx = dx - pe->offset.x, ty = dy - pe->offset.y;
+    int code = 0;
+    int i;
+
+    fill_params.rule = gx_rule_winding_number;
+    fill_params.flatness = pgs->flatness;
+    fill_params.adjust.x = STROKE_ADJUSTMENT(pe->always_thin, pgs, x);
+    fill_params.adjust.y = STROKE_ADJUSTMENT(pe->always_thin, pgs, y);
+    /* Leave dev->sgr as stroking the path would have. */
+    if (pe->sgr_set) {
+        pdev->sgr = pe->sgr;
+        for (i = 0; i < 2; i++) {
+            pdev->sgr.orig[i].x += dx, pdev->sgr.orig[i].y += dy;
+            pdev->sgr.adjusted[i].x += dx, pdev->sgr.adjusted[i].y += dy;
+        }
+    }
+    /* Leave the pieces translated, ready for the next similar position. */
+    if (tx != 0 || ty != 0) {
+        for (i = 0; i < pe->count; i++)
+            gx_path_translate(pe->pieces[i], tx, ty);
+        pe->offset.x = dx;
+        pe->offset.y = dy;
+    }
+    for (i = 0; i < pe->count && code >= 0; i++)
+        code = gx_fill_path_only(pe->pieces[i], pdev, pgs, &fill_params,
+                                 pdevc, pcpath);
+    return code;
+}
+
 int
 gx_stroke_path_only(gx_path * ppath, gx_path * to_path, gx_device * pdev,
                const gs_gstate * pgs, const gx_stroke_params * params,
                  const gx_device_color * pdevc, const gx_clip_path * pcpath)
 {
-    return gx_stroke_path_only_aux(ppath, to_path, pdev, pgs, params, pdevc, pcpath);
+    gx_stroke_cache *pcache = pgs->stroke_cache;
+    stroke_cache_key_t key;
+    stroke_cache_entry_t *pe;
+    stroke_outline_record *rec;
+    gx_stroked_gradient_recognizer_t entry_sgr;
+    bool sgr_set;
+    gx_path *path_copy;
+    ulong hash, *pseen;
+    int code;
+
+    /* Only strokes painted by stroke_fill are cached. */
+    if (pcache == NULL || to_path != NULL || pdevc == NULL ||
+        gx_dc_is_pattern1_color_clist_based(pdevc) ||
+        !stroke_cache_make_key(ppath, pdev, pgs, params, &key) ||
+        (hash = stroke_cache_hash(&key, ppath)) == 0 ||
+        stroke_cache_sgr_may_touch(ppath, pdev, pgs))
+        return gx_stroke_path_only_aux(ppath, to_path, pdev, pgs, params,
+                                       pdevc, pcpath, NULL);
+    pe = &pcache->entries[hash & (STROKE_CACHE_SIZE - 1)];
+    if (pe->path != NULL && pe->hash == hash &&
+        !memcmp(&pe->key, &key, sizeof(key))) {
+        fixed dx = ppath->first_subpath->pt.x - pe->path->first_subpath->pt.x;
+        fixed dy = ppath->first_subpath->pt.y - pe->path->first_subpath->pt.y;
+
+        if (stroke_cache_same_path(ppath, pe, dx, dy)) {
+            if_debug2m('o', ppath->memory,
+                       "[o]stroke cache hit, %d pieces, slot %d\n",
+                       pe->count, (int)(pe - pcache->entries));
+            return stroke_cache_replay(pe, dx, dy, pdev, pgs, pdevc, pcpath);
+        }
+    }
+    pseen = &pcache->seen[(hash >> 8) & (STROKE_CACHE_SIZE - 1)];
+    if (*pseen != hash) {
+        /* Only note the shape the first time. */
+        *pseen = hash;
+        return gx_stroke_path_only_aux(ppath, to_path, pdev, pgs, params,
+                                       pdevc, pcpath, NULL);
+    }
+    rec = (stroke_outline_record *)
+        gs_alloc_bytes(pcache->memory, sizeof(*rec), "gx_stroke_path_only");
+    if (rec == NULL)
+        return gx_stroke_path_only_aux(ppath, to_path, pdev, pgs, params,
+                                       pdevc, pcpath, NULL);
+    rec->memory = pcache->memory;
+    rec->ok = true;
+    rec->always_thin = false;
+    rec->count = 0;
+    /*
+     * Record from a remembered segment that can't match any segment of
+     * the path, which has the same effect as the actual one (see above),
+     * and which tells whether stroking the path changes it.
+     */
+    entry_sgr = pdev->sgr;
+    pdev->sgr.stroke_stored = true;
+    pdev->sgr.orig[3].x = pdev->sgr.orig[3].y = max_fixed;
+    code = gx_stroke_path_only_aux(ppath, to_path, pdev, pgs, params,
+                                   pdevc, pcpath, rec);
+    sgr_set = !(pdev->sgr.stroke_stored && pdev->sgr.orig[3].x == max_fixed &&
+                pdev->sgr.orig[3].y == max_fixed);
+    if (!sgr_set)
+        pdev->sgr = entry_sgr;
+    if (code >= 0 && rec->ok && rec->count > 0) {
+        gx_path **pieces = (gx_path **)
+            gs_alloc_bytes(pcache->memory, rec->count * sizeof(gx_path *),
+                           "gx_stroke_path_only(pieces)");
+
+        path_copy = gx_path_alloc(pcache->memory, "gx_stroke_path_only");
+        if (pieces != NULL && path_copy != NULL &&
+            gx_path_copy(ppath, path_copy) >= 0) {
+            stroke_cache_free_entry(pcache, pe);
+            memcpy(pieces, rec->pieces, rec->count * sizeof(gx_path *));
+            pe->hash = hash;
+            pe->key = key;
+            pe->path = path_copy;
+            pe->always_thin = rec->always_thin;
+            pe->count = rec->count;
+            pe->pieces = pieces;
+            pe->offset.x = pe->offset.y = 0;
+            pe->sgr_set = sgr_set;
+            pe->sgr = pdev->sgr;
+            rec->count = 0;
+        } else {
+            gs_free_object(pcache->memory, pieces, "gx_stroke_path_only(pieces)");
+            if (path_copy != NULL)
+                gx_path_free(path_copy, "gx_stroke_path_only");
+        }
+    }
+    stroke_free_pieces(rec->pieces, rec->count);
+    gs_free_object(pcache->memory, rec, "gx_stroke_path_only");
+    return code;
 }
 
 /* ------ Internal routines ------ */
@@ -111,6 +111,25 @@ int gx_ht_process_screen_memory(gs_screen_enum * penum, gs_gstate * pgs,
  * sizeof(ht_mask_t) would otherwise be sufficient.
  */
 
+/*
+ * The colored halftone code (gxcht.c) combines the tiles of up to 4
+ * components into a single tile of the LCM size.  We keep the last such
+ * tile, and what it was built from, with the cache of the first component,
+ * so that successive fills with the same color can reuse it (and its id).
+ */
+#define ht_colored_tile_longs 256
+typedef struct gx_ht_colored_tile_s {
+    gx_bitmap_id id;		/* gx_no_bitmap_id if not valid */
+    int depth;
+    int special;
+    gx_color_index plane_mask;
+    int width, height;
+    uint raster;
+    gx_bitmap_id plane_ids[4];
+    gx_color_index colors[16];
+    ulong data[ht_colored_tile_longs];
+} gx_ht_colored_tile;
+
 struct gx_ht_cache_s {
     /* The following are set when the cache is created. */
     byte *bits;			/* the base of the bits */
@@ -127,6 +146,7 @@ struct gx_ht_cache_s {
     gx_bitmap_id base_id;	/* the base id, to which */
                                 /* we add the halftone level */
     gx_ht_tile *(*render_ht)(gx_ht_cache *, int); /* rendering procedure */
+    gx_ht_colored_tile colored;	/* last colored tile, see above */
 };
 
 /* Define the sizes of the halftone cache. */
@@ -173,7 +193,8 @@ void gx_ht_free_cache(gs_memory_t *, gx_ht_cache *);
 /* Clear a halftone cache. */
 #define gx_ht_clear_cache(pcache)\
   ((pcache)->order.levels = 0, (pcache)->order.bit_data = 0,\
-   (pcache)->ht_tiles[0].tiles.data = 0)
+   (pcache)->ht_tiles[0].tiles.data = 0,\
+   (pcache)->colored.id = gx_no_bitmap_id)
 
 /* Initialize a halftone cache with a given order. */
 void gx_ht_init_cache(const gs_memory_t *mem, gx_ht_cache *, const gx_ht_order *);
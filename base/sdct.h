@@ -103,6 +103,8 @@ typedef struct jpeg_decompress_data_s {
                                          * so we use a function at the interpreter level
                                          */
     void *device;                       /* The device we need to send PassThrough data to */
+    struct dctd_pipe_s *pipe;           /* threaded decoding state (not GC memory), */
+                                        /* or NULL when decoding in the caller */
 } jpeg_decompress_data;
 
 #define private_st_jpeg_decompress_data()	/* in zfdctd.c */\
@@ -156,4 +158,7 @@ extern const stream_template s_DCTE_template;
 /* Clients do not call this. */
 void s_DCT_set_defaults(stream_state * st);
 
+/* Stop and free the decoding thread of a DCTDecode stream, if any. */
+void s_DCTD_release_pipe(jpeg_decompress_data *jddp);
+
 #endif /* sdct_INCLUDED */
@@ -65,6 +65,8 @@ stream_dct_finalize(const gs_memory_t *cmem, void *vptr)
         st->templat = &s_DCTE_template;
     }
     else {
+        if (ss->data.decompress != NULL)
+            s_DCTD_release_pipe(ss->data.decompress);
         gs_jpeg_destroy(ss);
         if (ss->data.decompress != NULL) {
             if (ss->data.decompress->scanline_buffer != NULL) {
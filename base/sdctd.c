@@ -17,10 +17,13 @@
 /* DCT decoding filter stream */
 #include "memory_.h"
 #include "stdio_.h"
+#include "string_.h"
 #include "jpeglib_.h"
 #include "jerror_.h"
 #include "gdebug.h"
 #include "gsmemory.h"
+#include "gslibctx.h"
+#include "gxsync.h"
 #include "strimpl.h"
 #include "sdct.h"
 #include "sjpeg.h"
@@ -86,6 +89,343 @@ dctd_term_source(j_decompress_ptr dinfo)
     return;
 }
 
+/* ------ Threaded decoding ------ */
+
+/*
+ * For large images (see the MinThreadedDecodeSize user parameter), once
+ * the headers have been read the scanlines are decoded by a separate
+ * thread into a small ring of strips, so that decompression overlaps
+ * whatever the caller does with the data.  The caller copies compressed
+ * data into a buffer owned by the pipe, since the stream buffer may be
+ * refilled or moved between calls; the decoding thread swaps it with the
+ * buffer it has consumed.  The decoding thread only touches the
+ * immovable jpeg_decompress_data and the pipe, which is allocated in
+ * non-GC (thread safe) memory; the library allocations go through the
+ * chunk allocator of this stream, which nothing else uses meanwhile.
+ */
+#define DCTD_PIPE_STRIPS 4
+#define DCTD_PIPE_STRIP_SIZE 65536
+#define DCTD_PIPE_INPUT_SIZE 65536
+
+typedef struct dctd_pipe_s {
+    gs_memory_t *memory;
+    gx_monitor_t *lock;		/* protects the fields below */
+    gx_semaphore_t *wake;	/* signalled to the decoding thread */
+    gx_semaphore_t *progress;	/* signalled by the decoding thread */
+    gp_thread_id thread;
+    jpeg_decompress_data *jddp;
+    byte *input[2];		/* the thread reads input[cur] */
+    int cur;
+    uint in_count;		/* bytes waiting in input[1 - cur] */
+    bool eod;			/* no more input after in_count */
+    bool abort;
+    uint line_size;
+    uint strip_lines;
+    byte *strips;		/* DCTD_PIPE_STRIPS * strip_lines lines */
+    uint strip_count[DCTD_PIPE_STRIPS];	/* # of lines in each strip */
+    ulong produced, consumed;	/* # of strips */
+    uint out_pos;		/* bytes already copied from the current strip */
+    int done;			/* 1 when finished, < 0 on error */
+    char message[JMSG_LENGTH_MAX];
+} dctd_pipe_t;
+
+/* Source manager procedures used while the decoding thread runs: wait */
+/* for the caller rather than suspending. */
+static boolean
+dctd_pipe_fill_input_buffer(j_decompress_ptr dinfo)
+{
+    jpeg_decompress_data *jddp =
+    (jpeg_decompress_data *) ((char *)dinfo -
+                              offset_of(jpeg_decompress_data, dinfo));
+    dctd_pipe_t *pipe = jddp->pipe;
+
+    gx_monitor_enter(pipe->lock);
+    while (pipe->in_count == 0 && !pipe->eod && !pipe->abort) {
+        gx_monitor_leave(pipe->lock);
+        gx_semaphore_wait(pipe->wake);
+        gx_monitor_enter(pipe->lock);
+    }
+    if (pipe->in_count == 0) {
+        gx_monitor_leave(pipe->lock);
+        WARNMS(dinfo, JWRN_JPEG_EOF);
+        dinfo->src->next_input_byte = fake_eoi;
+        dinfo->src->bytes_in_buffer = 2;
+        jddp->faked_eoi = true;
+        return TRUE;
+    }
+    pipe->cur = 1 - pipe->cur;
+    dinfo->src->next_input_byte = pipe->input[pipe->cur];
+    dinfo->src->bytes_in_buffer = pipe->in_count;
+    pipe->in_count = 0;
+    gx_monitor_leave(pipe->lock);
+    gx_semaphore_signal(pipe->progress);
+    return TRUE;
+}
+static void
+dctd_pipe_skip_input_data(j_decompress_ptr dinfo, long num_bytes)
+{
+    struct jpeg_source_mgr *src = dinfo->src;
+    jpeg_decompress_data *jddp =
+    (jpeg_decompress_data *) ((char *)dinfo -
+                              offset_of(jpeg_decompress_data, dinfo));
+
+    while (num_bytes > (long)src->bytes_in_buffer) {
+        num_bytes -= src->bytes_in_buffer;
+        src->next_input_byte += src->bytes_in_buffer;
+        src->bytes_in_buffer = 0;
+        dctd_pipe_fill_input_buffer(dinfo);
+        if (jddp->faked_eoi)
+            return;
+    }
+    if (num_bytes > 0) {
+        src->next_input_byte += num_bytes;
+        src->bytes_in_buffer -= num_bytes;
+    }
+}
+
+/* Decode the rest of the image; runs on the decoding thread. */
+/* This is kept separate from dctd_pipe_thread to limit the */
+/* side-effects of setjmp. */
+static int
+dctd_pipe_decode(dctd_pipe_t *pipe)
+{
+    jpeg_decompress_data *jddp = pipe->jddp;
+    j_decompress_ptr dinfo = &jddp->dinfo;
+
+    if (setjmp(find_jmp_buf(jddp->exit_jmpbuf))) {
+        (*dinfo->err->format_message) ((j_common_ptr)dinfo, pipe->message);
+        return -1;
+    }
+    for (;;) {
+        uint slot = pipe->produced % DCTD_PIPE_STRIPS;
+        byte *line = pipe->strips +
+            (ulong)slot * pipe->strip_lines * pipe->line_size;
+        uint count = 0;
+        bool abort;
+
+        gx_monitor_enter(pipe->lock);
+        while (!pipe->abort &&
+               pipe->produced - pipe->consumed >= DCTD_PIPE_STRIPS) {
+            gx_monitor_leave(pipe->lock);
+            gx_semaphore_wait(pipe->wake);
+            gx_monitor_enter(pipe->lock);
+        }
+        abort = pipe->abort;
+        gx_monitor_leave(pipe->lock);
+        if (abort)
+            return 0;
+        if (dinfo->output_scanline >= dinfo->output_height)
+            break;
+        while (count < pipe->strip_lines &&
+               dinfo->output_scanline < dinfo->output_height) {
+            JSAMPROW row = line;
+
+            /* The source never suspends, so this always reads a line. */
+            if (jpeg_read_scanlines(dinfo, &row, 1) != 1) {
+                strcpy(pipe->message, "DCTDecode: no scanline decoded");
+                return -1;
+            }
+            line += pipe->line_size;
+            count++;
+        }
+        gx_monitor_enter(pipe->lock);
+        pipe->strip_count[slot] = count;
+        pipe->produced++;
+        gx_monitor_leave(pipe->lock);
+        gx_semaphore_signal(pipe->progress);
+    }
+    jpeg_finish_decompress(dinfo);
+    return 1;
+}
+
+static void
+dctd_pipe_thread(void *data)
+{
+    dctd_pipe_t *pipe = (dctd_pipe_t *)data;
+    int code = dctd_pipe_decode(pipe);
+
+    gx_monitor_enter(pipe->lock);
+    pipe->done = (code < 0 ? code : 1);
+    gx_monitor_leave(pipe->lock);
+    gx_semaphore_signal(pipe->progress);
+}
+
+static void
+dctd_pipe_free(dctd_pipe_t *pipe)
+{
+    gs_memory_t *mem = pipe->memory;
+
+    if (pipe->lock)
+        gx_monitor_free(pipe->lock);
+    if (pipe->wake)
+        gx_semaphore_free(pipe->wake);
+    if (pipe->progress)
+        gx_semaphore_free(pipe->progress);
+    gs_free_object(mem, pipe->strips, "dctd_pipe_free(strips)");
+    gs_free_object(mem, pipe->input[0], "dctd_pipe_free(input)");
+    gs_free_object(mem, pipe->input[1], "dctd_pipe_free(input)");
+    gs_free_object(mem, pipe, "dctd_pipe_free");
+}
+
+/*
+ * Start decoding the rest of the image on a separate thread, after
+ * start_decompress.  Return 0 (and leave the stream as it was) if the
+ * image is too small or the thread can't be started.
+ */
+static int
+dctd_pipe_start(stream_DCT_state *ss, stream_cursor_read *pr)
+{
+    jpeg_decompress_data *jddp = ss->data.decompress;
+    struct jpeg_source_mgr *src = jddp->dinfo.src;
+    long min_size = ss->memory->gs_lib_ctx->min_threaded_decode;
+    gs_memory_t *mem = ss->memory->non_gc_memory;
+    dctd_pipe_t *pipe;
+    uint n;
+
+    if (min_size <= 0 || jddp->PassThrough || jddp->skip != 0 ||
+        jddp->faked_eoi || ss->scan_line_size == 0 ||
+        (double)ss->scan_line_size * jddp->dinfo.output_height < min_size)
+        return 0;
+    pipe = (dctd_pipe_t *)gs_alloc_bytes(mem, sizeof(dctd_pipe_t),
+                                         "dctd_pipe_start");
+    if (pipe == NULL)
+        return 0;
+    memset(pipe, 0, sizeof(*pipe));
+    pipe->memory = mem;
+    pipe->jddp = jddp;
+    pipe->line_size = ss->scan_line_size;
+    pipe->strip_lines = max(DCTD_PIPE_STRIP_SIZE / pipe->line_size, 1);
+    pipe->strips = gs_alloc_bytes(mem, (ulong)DCTD_PIPE_STRIPS *
+                                  pipe->strip_lines * pipe->line_size,
+                                  "dctd_pipe_start(strips)");
+    pipe->input[0] = gs_alloc_bytes(mem, DCTD_PIPE_INPUT_SIZE,
+                                    "dctd_pipe_start(input)");
+    pipe->input[1] = gs_alloc_bytes(mem, DCTD_PIPE_INPUT_SIZE,
+                                    "dctd_pipe_start(input)");
+    pipe->lock = gx_monitor_label(gx_monitor_alloc(mem), "DCTD pipe");
+    pipe->wake = gx_semaphore_label(gx_semaphore_alloc(mem), "DCTD wake");
+    pipe->progress = gx_semaphore_label(gx_semaphore_alloc(mem),
+                                        "DCTD progress");
+    if (pipe->strips == NULL || pipe->input[0] == NULL ||
+        pipe->input[1] == NULL || pipe->lock == NULL ||
+        pipe->wake == NULL || pipe->progress == NULL) {
+        dctd_pipe_free(pipe);
+        return 0;
+    }
+    /* Hand whatever input the library hasn't consumed yet to the thread. */
+    n = min(src->bytes_in_buffer, DCTD_PIPE_INPUT_SIZE);
+    memcpy(pipe->input[0], src->next_input_byte, n);
+    pr->ptr = src->next_input_byte - 1 + n;
+    src->next_input_byte = pipe->input[0];
+    src->bytes_in_buffer = n;
+    src->fill_input_buffer = dctd_pipe_fill_input_buffer;
+    src->skip_input_data = dctd_pipe_skip_input_data;
+    jddp->pipe = pipe;
+    if (gp_thread_start(dctd_pipe_thread, pipe, &pipe->thread) < 0) {
+        /* Decode in this thread after all: give the input back to the */
+        /* source buffer, from where the library reads it again. */
+        src->fill_input_buffer = dctd_fill_input_buffer;
+        src->skip_input_data = dctd_skip_input_data;
+        pr->ptr -= n;
+        src->next_input_byte = pr->ptr + 1;
+        src->bytes_in_buffer = pr->limit - pr->ptr;
+        jddp->pipe = NULL;
+        dctd_pipe_free(pipe);
+        return 0;
+    }
+    gp_thread_label(pipe->thread, "DCTD pipe");
+    if_debug2m('w', ss->memory, "[wdd]decoding on a thread, %u lines/strip of %u\n",
+               pipe->strip_lines, pipe->line_size);
+    return 1;
+}
+
+/* Stop the decoding thread, if any, and free the pipe. */
+void
+s_DCTD_release_pipe(jpeg_decompress_data *jddp)
+{
+    dctd_pipe_t *pipe = jddp->pipe;
+
+    if (pipe == NULL)
+        return;
+    gx_monitor_enter(pipe->lock);
+    pipe->abort = true;
+    gx_monitor_leave(pipe->lock);
+    gx_semaphore_signal(pipe->wake);
+    gp_thread_finish(pipe->thread);
+    jddp->pipe = NULL;
+    dctd_pipe_free(pipe);
+}
+
+/* Process a buffer while the decoding thread runs. */
+static int
+dctd_pipe_process(stream_DCT_state *ss, stream_cursor_read *pr,
+                  stream_cursor_write *pw, bool last)
+{
+    dctd_pipe_t *pipe = ss->data.decompress->pipe;
+
+    for (;;) {
+        bool fed = false;
+        int done;
+
+        gx_monitor_enter(pipe->lock);
+        if (pipe->consumed < pipe->produced) {
+            uint slot = pipe->consumed % DCTD_PIPE_STRIPS;
+            uint size = pipe->strip_count[slot] * pipe->line_size;
+            uint count;
+
+            /* The thread leaves this strip alone until we release it. */
+            gx_monitor_leave(pipe->lock);
+            count = min(size - pipe->out_pos, pw->limit - pw->ptr);
+            memcpy(pw->ptr + 1, pipe->strips +
+                   (ulong)slot * pipe->strip_lines * pipe->line_size +
+                   pipe->out_pos, count);
+            pw->ptr += count;
+            pipe->out_pos += count;
+            if (pipe->out_pos < size)
+                return 1;	/* need more room */
+            pipe->out_pos = 0;
+            gx_monitor_enter(pipe->lock);
+            pipe->consumed++;
+            gx_monitor_leave(pipe->lock);
+            gx_semaphore_signal(pipe->wake);
+            continue;
+        }
+        done = pipe->done;
+        if (!done && pipe->in_count == 0 && !pipe->eod) {
+            uint count = min(pr->limit - pr->ptr, DCTD_PIPE_INPUT_SIZE);
+
+            if (count > 0) {
+                memcpy(pipe->input[1 - pipe->cur], pr->ptr + 1, count);
+                pr->ptr += count;
+                pipe->in_count = count;
+                fed = true;
+            } else if (last) {
+                pipe->eod = true;
+                fed = true;
+            } else {
+                gx_monitor_leave(pipe->lock);
+                return 0;	/* need more data */
+            }
+        }
+        gx_monitor_leave(pipe->lock);
+        if (done) {
+            gp_thread_finish(pipe->thread);
+            ss->data.decompress->pipe = NULL;
+            if (done < 0)
+                (*ss->report_error) ((stream_state *) ss, pipe->message);
+            dctd_pipe_free(pipe);
+            if (done < 0)
+                return ERRC;
+            ss->phase = 5;
+            return EOFC;
+        }
+        if (fed)
+            gx_semaphore_signal(pipe->wake);
+        else
+            gx_semaphore_wait(pipe->progress);
+    }
+}
+
 /* Set the defaults for the DCTDecode filter. */
 static void
 s_DCTD_set_defaults(stream_state * st)
@@ -110,6 +450,7 @@ s_DCTD_init(stream_state * st)
     ss->data.decompress->skip = 0;
     ss->data.decompress->input_eod = false;
     ss->data.decompress->faked_eoi = false;
+    ss->data.decompress->pipe = NULL;
     ss->phase = 0;
     return 0;
 }
@@ -188,6 +529,8 @@ s_DCTD_process(stream_state * st, stream_cursor_read * pr,
 
     if_debug3m('w', st->memory, "[wdd]process avail=%u, skip=%u, last=%d\n",
                (uint) (pr->limit - pr->ptr), (uint) jddp->skip, last);
+    if (jddp->pipe != NULL)
+        return dctd_pipe_process(ss, pr, pw, last);
     if (jddp->skip != 0) {
         long avail = pr->limit - pr->ptr;
 
@@ -300,6 +643,10 @@ s_DCTD_process(stream_state * st, stream_cursor_read * pr,
                        jddp->dinfo.output_width,
                        jddp->dinfo.output_components,
                        ss->scan_line_size, jddp->templat.min_out_size);
+            if (dctd_pipe_start(ss, pr)) {
+                ss->phase = 3;
+                return dctd_pipe_process(ss, pr, pw, last);
+            }
             if (ss->scan_line_size > (uint) jddp->templat.min_out_size) {
                 /* Create a spare buffer for oversize scanline */
                 jddp->scanline_buffer =
@@ -417,8 +764,21 @@ s_DCTD_process(stream_state * st, stream_cursor_read * pr,
     return ERRC;
 }
 
+/* Release the stream. */
+/* Stop the decoding thread as soon as the filter is closed, rather than */
+/* leaving it blocked (with its strips allocated) until the GC finalizes */
+/* the state; stream_dct_finalize still frees the rest of it. */
+static void
+s_DCTD_release(stream_state * st)
+{
+    stream_DCT_state *const ss = (stream_DCT_state *) st;
+
+    if (ss->data.decompress != NULL)
+        s_DCTD_release_pipe(ss->data.decompress);
+}
+
 /* Stream template */
 const stream_template s_DCTD_template =
-{&st_DCT_state, s_DCTD_init, s_DCTD_process, 2000, 4000, NULL,
+{&st_DCT_state, s_DCTD_init, s_DCTD_process, 2000, 4000, s_DCTD_release,
  s_DCTD_set_defaults
 };
@@ -288,15 +288,51 @@ $(DEVOBJ)gdevpsu.$(OBJ) : $(DEVVECSRC)gdevpsu.c $(GX) $(GDEV) $(math__h) $(time_
 
 display_=$(DEVOBJ)gdevdsp.$(OBJ) $(DEVOBJ)gdevpccm.$(OBJ) $(GLOBJ)gdevdevn.$(OBJ) \
 	 $(GLOBJ)gsequivc.$(OBJ) $(DEVOBJ)gdevdcrd.$(OBJ)
-$(DD)display.dev : $(display_) $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
+$(DD)display.dev : $(display_) $(GLD)page.dev $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
 	$(SETDEV) $(DD)display $(display_)
+	$(ADDMOD) $(DD)display -include $(GLD)page
 
 $(DEVOBJ)gdevdsp.$(OBJ) : $(DEVSRC)gdevdsp.c $(string__h)\
  $(gp_h) $(gpcheck_h) $(gdevpccm_h) $(gsparam_h) $(gsdevice_h)\
  $(GDEVH) $(gxdevmem_h) $(gdevdevn_h) $(gsequivc_h) $(gdevdsp_h) $(gdevdsp2_h) \
-  $(DEVS_MAK) $(MAKEDIRS)
+ $(gdevprn_h) $(gxgetbit_h) $(DEVS_MAK) $(MAKEDIRS)
 	$(DEVCC) $(DEVO_)gdevdsp.$(OBJ) $(C_) $(DEVSRC)gdevdsp.c
 
+### -------------- Band streaming devices for DLL platforms ------------- ###
+
+band_=$(DEVOBJ)gdevband.$(OBJ)
+$(DD)bandgray.dev : $(band_) $(GLD)page.dev $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
+	$(SETPDEV2) $(DD)bandgray $(band_)
+
+$(DD)bandrgb.dev : $(band_) $(GLD)page.dev $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
+	$(SETPDEV2) $(DD)bandrgb $(band_)
+
+$(DD)bandcmyk.dev : $(band_) $(GLD)page.dev $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
+	$(SETPDEV2) $(DD)bandcmyk $(band_)
+
+$(DEVOBJ)gdevband.$(OBJ) : $(DEVSRC)gdevband.c $(gdevprn_h) $(gdevmem_h)\
+ $(gxgetbit_h) $(gxdownscale_h) $(gxdevsop_h) $(gslibctx_h)\
+ $(gxclthrd_h) $(gxsync_h) $(gpsync_h)\
+ $(gdevband_h) $(gdevband2_h) $(DEVS_MAK) $(MAKEDIRS)
+	$(DEVCC) $(DEVO_)gdevband.$(OBJ) $(C_) $(DEVSRC)gdevband.c
+
+### -------- Devices writing a page at several resolutions at once ------ ###
+
+mult_=$(DEVOBJ)gdevmult.$(OBJ)
+$(DD)multigray.dev : $(mult_) $(GLD)page.dev $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
+	$(SETPDEV2) $(DD)multigray $(mult_)
+
+$(DD)multirgb.dev : $(mult_) $(GLD)page.dev $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
+	$(SETPDEV2) $(DD)multirgb $(mult_)
+
+$(DD)multicmyk.dev : $(mult_) $(GLD)page.dev $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
+	$(SETPDEV2) $(DD)multicmyk $(mult_)
+
+$(DEVOBJ)gdevmult.$(OBJ) : $(DEVSRC)gdevmult.c $(PDEVH) $(stdint__h)\
+ $(stdio__h) $(ctype__h) $(gxgetbit_h) $(gscms_h) $(gsicc_cache_h)\
+ $(gsicc_manage_h) $(DEVS_MAK) $(MAKEDIRS)
+	$(DEVCC) $(DEVO_)gdevmult.$(OBJ) $(C_) $(DEVSRC)gdevmult.c
+
 ### -------------------------- The X11 device -------------------------- ###
 
 # Please note that Artifex Software Inc does not support Ghostview.
@@ -1300,7 +1336,8 @@ $(DD)jpegcmyk.dev : $(jpeg_) $(GLD)sdcte.dev $(GLD)page.dev\
 
 $(DEVOBJ)gdevjpeg.$(OBJ) : $(DEVSRC)gdevjpeg.c $(PDEVH)\
  $(stdio__h) $(jpeglib__h)\
- $(sdct_h) $(sjpeg_h) $(stream_h) $(strimpl_h) $(DEVS_MAK) $(MAKEDIRS)
+ $(sdct_h) $(sjpeg_h) $(stream_h) $(strimpl_h) $(gxgetbit_h)\
+ $(DEVS_MAK) $(MAKEDIRS)
 	$(DEVCC) $(DEVO_)gdevjpeg.$(OBJ) $(C_) $(DEVSRC)gdevjpeg.c
 
 ### ------------------------- MIFF file format ------------------------- ###
@@ -1459,7 +1496,8 @@ libpng_dev=$(PNGGENDIR)$(D)libpng.dev
 png_i_=-include $(PNGGENDIR)$(D)libpng
 
 $(DEVOBJ)gdevpng.$(OBJ) : $(DEVSRC)gdevpng.c\
- $(gdevprn_h) $(gdevpccm_h) $(gscdefs_h) $(png__h) $(DEVS_MAK) $(MAKEDIRS)
+ $(gdevprn_h) $(gdevpccm_h) $(gscdefs_h) $(png__h) $(zlib_h) $(gxgetbit_h)\
+ $(DEVS_MAK) $(MAKEDIRS)
 	$(CC_) $(I_)$(DEVI_) $(II)$(PI_)$(_I) $(PCF_) $(GLF_) $(DEVO_)gdevpng.$(OBJ) $(C_) $(DEVSRC)gdevpng.c
 
 $(DD)pngmono.dev : $(libpng_dev) $(png_) $(GLD)page.dev $(GDEV) \
@@ -1618,7 +1656,7 @@ $(DD)tiffs.dev : $(libtiff_dev) $(tiffs_) $(GLD)page.dev\
 	$(ADDMOD) $(DD)tiffs -include $(GLD)page $(tiff_i_)
 
 $(DEVOBJ)gdevtifs.$(OBJ) : $(DEVSRC)gdevtifs.c $(PDEVH) $(stdint__h) $(stdio__h) $(time__h)\
- $(gdevtifs_h) $(gscdefs_h) $(gstypes_h) $(stream_h) $(strmio_h) $(gstiffio_h)\
+ $(gdevtifs_h) $(gscdefs_h) $(gstypes_h) $(stream_h) $(strmio_h) $(gstiffio_h) $(gxgetbit_h)\
  $(gsicc_cache_h) $(gscms_h) $(DEVS_MAK) $(MAKEDIRS)
 	$(DEVCC) $(I_)$(DEVI_) $(II)$(TI_)$(_I) $(DEVO_)gdevtifs.$(OBJ) $(C_) $(DEVSRC)gdevtifs.c
 
@@ -1669,7 +1707,8 @@ $(DD)tiffgray.dev : $(libtiff_dev) $(tiffgray_) $(DD)tiffs.dev\
 $(DEVOBJ)gdevtsep.$(OBJ) : $(DEVSRC)gdevtsep.c $(PDEVH) $(stdint__h)\
  $(gdevtifs_h) $(gdevdevn_h) $(gxdevsop_h) $(gsequivc_h) $(stdio__h) $(ctype__h)\
  $(gxgetbit_h) $(gdevppla_h) $(gp_h) $(gstiffio_h) $(gsicc_h)\
- $(gscms_h) $(gsicc_cache_h) $(gxdevsop_h) $(GDEV) $(DEVS_MAK) $(MAKEDIRS)
+ $(gscms_h) $(gsicc_cache_h) $(gxdevsop_h) $(gsflip_h) $(GDEV) $(DEVS_MAK)\
+ $(MAKEDIRS)
 	$(DEVCC) $(I_)$(TI_)$(_I) $(DEVO_)gdevtsep.$(OBJ) $(C_) $(DEVSRC)gdevtsep.c
 
 # TIFF Scaled (downscaled gray -> mono), configurable compression
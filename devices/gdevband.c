@@ -0,0 +1,892 @@
+/* Copyright (C) 2001-2018 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+
+
+/* Band streaming devices for DLL platforms.  See gdevband.h. */
+
+#include "gdevprn.h"
+#include "gdevmem.h"
+#include "gxgetbit.h"
+#include "gxdownscale.h"
+#include "gxdevsop.h"
+#include "gslibctx.h"
+#include "gxclthrd.h"
+#include "gxsync.h"
+#include "gpsync.h"
+#include "gdevband.h"
+#include "gdevband2.h"
+
+/* ------ The device descriptors ------ */
+
+/*
+ * Default X and Y resolution.
+ */
+#define X_DPI 72
+#define Y_DPI 72
+
+/* Default size of the tile cache for KeepPage. */
+#define BAND_TILE_CACHE_SIZE (16 * 1024 * 1024)
+
+static dev_proc_open_device(band_open);
+static dev_proc_output_page(band_output_page);
+static dev_proc_close_device(band_close);
+static void band_free_page(gx_device_band *bdev);
+
+/* Not in a header; gdevprn.c declares it the same way. */
+extern dev_proc_open_device(clist_open);
+static dev_proc_print_page(band_print_page);
+
+static int
+band_get_param(gx_device *dev, char *Param, void *list)
+{
+    gx_device_band *pdev = (gx_device_band *)dev;
+    gs_param_list * plist = (gs_param_list *)list;
+
+    if (strcmp(Param, "DownScaleFactor") == 0) {
+        return param_write_int(plist, "DownScaleFactor", &pdev->downscale.downscale_factor);
+    }
+    return gdev_prn_get_param(dev, Param, list);
+}
+
+static int
+band_get_params(gx_device * dev, gs_param_list * plist)
+{
+    gx_device_band *pdev = (gx_device_band *)dev;
+    int code, ecode;
+
+    ecode = 0;
+    if ((code = gx_downscaler_write_params(plist, &pdev->downscale, 0)) < 0)
+        ecode = code;
+    if ((code = param_write_bool(plist, "KeepPage", &pdev->KeepPage)) < 0)
+        ecode = code;
+    if ((code = param_write_int(plist, "TileCacheSize", &pdev->TileCacheSize)) < 0)
+        ecode = code;
+
+    code = gdev_prn_get_params(dev, plist);
+    if (code < 0)
+        ecode = code;
+
+    return ecode;
+}
+
+static int
+band_put_params(gx_device *dev, gs_param_list *plist)
+{
+    gx_device_band *pdev = (gx_device_band *)dev;
+    bool keep_page = pdev->KeepPage;
+    int tile_cache_size = pdev->TileCacheSize;
+    int code, ecode;
+
+    ecode = gx_downscaler_read_params(plist, &pdev->downscale, 0);
+
+    if ((code = param_read_bool(plist, "KeepPage", &keep_page)) < 0) {
+        param_signal_error(plist, "KeepPage", code);
+        ecode = code;
+    }
+    switch (code = param_read_int(plist, "TileCacheSize", &tile_cache_size)) {
+        case 0:
+            if (tile_cache_size >= 0)
+                break;
+            code = gs_error_rangecheck;
+        default:
+            param_signal_error(plist, "TileCacheSize", code);
+            ecode = code;
+        case 1:
+            break;
+    }
+
+    code = gdev_prn_put_params(dev, plist);
+    if (code < 0)
+        ecode = code;
+    if (ecode < 0)
+        return ecode;
+
+    pdev->TileCacheSize = tile_cache_size;
+    if (keep_page != pdev->KeepPage) {
+        /* Only a clist can be kept, so always band while keeping pages. */
+        pdev->KeepPage = keep_page;
+        if (!keep_page)
+            band_free_page(pdev);
+        pdev->space_params.banding_type =
+            (keep_page ? BandingAlways : BandingAuto);
+        if (dev->is_open)
+            ecode = gdev_prn_reallocate_memory(dev, &pdev->space_params,
+                                               dev->width, dev->height);
+    }
+    return ecode;
+}
+
+static int
+band_dev_spec_op(gx_device *pdev, int dev_spec_op, void *data, int size)
+{
+    gx_device_band *bdev = (gx_device_band *)pdev;
+
+    if (dev_spec_op == gxdso_adjust_bandheight)
+        return gx_downscaler_adjust_bandheight(bdev->downscale.downscale_factor, size);
+
+    if (dev_spec_op == gxdso_get_dev_param) {
+        int code;
+        dev_param_req_t *request = (dev_param_req_t *)data;
+        code = band_get_param(pdev, request->Param, request->list);
+        if (code != gs_error_undefined)
+            return code;
+    }
+
+    return gdev_prn_dev_spec_op(pdev, dev_spec_op, data, size);
+}
+
+/* Since the print_page doesn't alter the device, this device can print in the background */
+#define band_procs(map_rgb_color, map_color_rgb, map_cmyk_color)\
+{\
+        band_open,\
+        NULL,	/* get_initial_matrix */\
+        NULL,	/* sync_output */\
+        band_output_page,\
+        band_close,\
+        map_rgb_color,\
+        map_color_rgb,\
+        NULL,	/* fill_rectangle */\
+        NULL,	/* tile_rectangle */\
+        NULL,	/* copy_mono */\
+        NULL,	/* copy_color */\
+        NULL,	/* draw_line */\
+        NULL,	/* get_bits */\
+        band_get_params,\
+        band_put_params,\
+        map_cmyk_color,\
+        NULL,	/* get_xfont_procs */\
+        NULL,	/* get_xfont_device */\
+        NULL,	/* map_rgb_alpha_color */\
+        gx_page_device_get_page_device,\
+        NULL,	/* get_alpha_bits */\
+        NULL,	/* copy_alpha */\
+        NULL,	/* get_band */\
+        NULL,	/* copy_rop */\
+        NULL,	/* fill_path */\
+        NULL,	/* stroke_path */\
+        NULL,	/* fill_mask */\
+        NULL,	/* fill_trapezoid */\
+        NULL,	/* fill_parallelogram */\
+        NULL,	/* fill_triangle */\
+        NULL,	/* draw_thin_line */\
+        NULL,	/* begin_image */\
+        NULL,	/* image_data */\
+        NULL,	/* end_image */\
+        NULL,	/* strip_tile_rectangle */\
+        NULL,	/* strip_copy_rop, */\
+        NULL,	/* get_clipping_box */\
+        NULL,	/* begin_typed_image */\
+        NULL,	/* get_bits_rectangle */\
+        NULL,	/* map_color_rgb_alpha */\
+        NULL,	/* create_compositor */\
+        NULL,	/* get_hardware_params */\
+        NULL,	/* text_begin */\
+        NULL,	/* finish_copydevice */\
+        NULL,	/* begin_transparency_group */\
+        NULL,	/* end_transparency_group */\
+        NULL,	/* begin_transparency_mask */\
+        NULL,	/* end_transparency_mask */\
+        NULL,  /* discard_transparency_layer */\
+        NULL,  /* get_color_mapping_procs */\
+        NULL,  /* get_color_comp_index */\
+        NULL,  /* encode_color */\
+        NULL,  /* decode_color */\
+        NULL,  /* pattern_manage */\
+        NULL,  /* fill_rectangle_hl_color */\
+        NULL,  /* include_color_space */\
+        NULL,  /* fill_linear_color_scanline */\
+        NULL,  /* fill_linear_color_trapezoid */\
+        NULL,  /* fill_linear_color_triangle */\
+        NULL,  /* update_spot_equivalent_colors */\
+        NULL,  /* ret_devn_params */\
+        NULL,  /* fillpage */\
+        NULL,  /* push_transparency_state */\
+        NULL,  /* pop_transparency_state */\
+        NULL,  /* put_image */\
+        band_dev_spec_op,  /* dev_spec_op */\
+        NULL,  /* copy plane */\
+        gx_default_get_profile, /* get_profile */\
+        gx_default_set_graphics_type_tag /* set_graphics_type_tag */\
+}
+
+/* 8-bit gray. */
+
+static const gx_device_procs bandgray_procs =
+    band_procs(gx_default_gray_map_rgb_color, gx_default_gray_map_color_rgb,
+               NULL);
+const gx_device_band gs_bandgray_device =
+{prn_device_body(gx_device_band, bandgray_procs, "bandgray",
+                 DEFAULT_WIDTH_10THS, DEFAULT_HEIGHT_10THS,
+                 X_DPI, Y_DPI,
+                 0, 0, 0, 0,	/* margins */
+                 1, 8, 255, 0, 256, 0, band_print_page),
+                 GX_DOWNSCALER_PARAMS_DEFAULTS,
+                 NULL,		/* callback */
+                 false,		/* KeepPage */
+                 BAND_TILE_CACHE_SIZE,
+                 NULL		/* page */
+};
+
+/* 24-bit color. */
+
+static const gx_device_procs bandrgb_procs =
+    band_procs(gx_default_rgb_map_rgb_color, gx_default_rgb_map_color_rgb,
+               NULL);
+const gx_device_band gs_bandrgb_device =
+{prn_device_body(gx_device_band, bandrgb_procs, "bandrgb",
+                 DEFAULT_WIDTH_10THS, DEFAULT_HEIGHT_10THS,
+                 X_DPI, Y_DPI,
+                 0, 0, 0, 0,	/* margins */
+                 3, 24, 255, 255, 256, 256, band_print_page),
+                 GX_DOWNSCALER_PARAMS_DEFAULTS,
+                 NULL,		/* callback */
+                 false,		/* KeepPage */
+                 BAND_TILE_CACHE_SIZE,
+                 NULL		/* page */
+};
+
+/* 32-bit CMYK. */
+
+static const gx_device_procs bandcmyk_procs =
+    band_procs(NULL, cmyk_8bit_map_color_rgb, cmyk_8bit_map_cmyk_color);
+const gx_device_band gs_bandcmyk_device =
+{prn_device_std_body(gx_device_band, bandcmyk_procs, "bandcmyk",
+                     DEFAULT_WIDTH_10THS, DEFAULT_HEIGHT_10THS,
+                     X_DPI, Y_DPI,
+                     0, 0, 0, 0,	/* margins */
+                     32, band_print_page),
+                 GX_DOWNSCALER_PARAMS_DEFAULTS,
+                 NULL,		/* callback */
+                 false,		/* KeepPage */
+                 BAND_TILE_CACHE_SIZE,
+                 NULL		/* page */
+};
+
+/* ------ Private definitions ------ */
+
+/* Nothing is ever written to the output file, so don't insist on one. */
+static int
+band_open(gx_device *pdev)
+{
+    gx_device_printer *ppdev = (gx_device_printer *)pdev;
+
+    if (ppdev->fname[0] == 0)
+        strcpy(ppdev->fname, "-");
+    return gdev_prn_open(pdev);
+}
+
+static int
+band_check_structure(gx_device_band *bdev)
+{
+    band_callback *callback = bdev->callback;
+
+    if (callback == NULL) {
+        emprintf1(bdev->memory,
+                  "Device '%s' requires gsapi_set_band_callback.\n",
+                  bdev->dname);
+        return_error(gs_error_undefined);
+    }
+    if (callback->size != sizeof(band_callback) ||
+        callback->version_major != BAND_VERSION_MAJOR ||
+        callback->band_page_begin == NULL ||
+        callback->band_data == NULL ||
+        callback->band_page_end == NULL)
+        return_error(gs_error_rangecheck);
+    return 0;
+}
+
+/* What a rendering thread leaves behind for band_output. */
+typedef struct band_buffer_s {
+    const byte *data;
+    int raster;
+    int y;
+    int height;
+} band_buffer_t;
+
+static int
+band_init_buffer(void *arg, gx_device *dev, gs_memory_t *mem, int w, int h, void **pbuffer)
+{
+    band_buffer_t *buffer;
+
+    buffer = (band_buffer_t *)gs_alloc_bytes(mem, sizeof(band_buffer_t), "band_init_buffer");
+    *pbuffer = (void *)buffer;
+    if (buffer == NULL)
+        return_error(gs_error_VMerror);
+    memset(buffer, 0, sizeof(*buffer));
+    return 0;
+}
+
+static void
+band_free_buffer(void *arg, gx_device *dev, gs_memory_t *mem, void *buffer)
+{
+    gs_free_object(mem, buffer, "band_init_buffer");
+}
+
+/*
+ * Runs on the rendering thread.  The band is already rendered (and
+ * downscaled in place) in bdev, so just note where it is; bdev is left
+ * alone until band_output has run.
+ */
+static int
+band_process(void *arg, gx_device *dev, gx_device *bdev, const gs_int_rect *rect, void *buffer_)
+{
+    band_buffer_t *buffer = (band_buffer_t *)buffer_;
+    gs_get_bits_params_t params;
+    gs_int_rect my_rect;
+    int code;
+
+    my_rect.p.x = 0;
+    my_rect.p.y = 0;
+    my_rect.q.x = rect->q.x - rect->p.x;
+    my_rect.q.y = rect->q.y - rect->p.y;
+    params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_CHUNKY |
+                     GB_RETURN_POINTER | GB_ALIGN_ANY | GB_OFFSET_0 | GB_RASTER_ANY;
+    code = dev_proc(bdev, get_bits_rectangle)(bdev, &my_rect, &params, NULL);
+    if (code < 0)
+        return code;
+
+    buffer->data = params.data[0];
+    buffer->raster = gx_device_raster(bdev, true);
+    buffer->y = rect->p.y;
+    buffer->height = my_rect.q.y;
+    return 0;
+}
+
+/* Runs on the main thread, in band order. */
+static int
+band_output(void *arg, gx_device *dev, void *buffer_)
+{
+    gx_device_band *bdev = (gx_device_band *)dev;
+    band_buffer_t *buffer = (band_buffer_t *)buffer_;
+    int code;
+
+    code = (*bdev->callback->band_data)(dev->memory->gs_lib_ctx->caller_handle,
+                                        dev, buffer->y, buffer->height,
+                                        buffer->raster, buffer->data);
+    if (code < 0)
+        return_error(code);
+    return 0;
+}
+
+/* Hand a page to the caller, band by band. */
+static int
+band_print_page(gx_device_printer *pdev, FILE *file)
+{
+    gx_device_band *bdev = (gx_device_band *)pdev;
+    void *handle = pdev->memory->gs_lib_ctx->caller_handle;
+    int factor = bdev->downscale.downscale_factor;
+    gx_process_page_options_t process = { 0 };
+    int code, ecode;
+
+    code = band_check_structure(bdev);
+    if (code < 0)
+        return code;
+
+    code = (*bdev->callback->band_page_begin)(handle, pdev,
+                gx_downscaler_scale_rounded(pdev->width, factor),
+                gx_downscaler_scale_rounded(pdev->height, factor),
+                pdev->color_info.num_components);
+    if (code < 0)
+        return_error(code);
+
+    process.init_buffer_fn = band_init_buffer;
+    process.free_buffer_fn = band_free_buffer;
+    process.process_fn = band_process;
+    process.output_fn = band_output;
+    process.arg = NULL;
+
+    code = gx_downscaler_process_page((gx_device *)pdev, &process, factor);
+
+    ecode = (*bdev->callback->band_page_end)(handle, pdev, code < 0 ? code : 0);
+    if (code < 0)
+        return code;
+    if (ecode < 0)
+        return_error(ecode);
+    return 0;
+}
+
+/* ------ Kept pages and tiles ------ */
+
+/* A rendered tile in the cache. */
+typedef struct band_tile_entry_s band_tile_entry;
+struct band_tile_entry_s {
+    band_tile_entry *next;
+    int x, y, width, height, scale;
+    uint size;
+    byte *data;			/* width * bytes per pixel per row */
+};
+
+/*
+ * The clist of a kept page.  Like a page printed in the background, it
+ * has its own reader device and owns the band files, which are deleted
+ * when the page is freed.
+ */
+struct band_page_s {
+    char *cfname;
+    char *bfname;
+    clist_file_ptr cfile;
+    clist_file_ptr bfile;
+    const clist_io_procs_t *io_procs;
+    gx_device **workers;	/* workers[0] is the reader, the rest clone it */
+    int num_workers;
+    int max_workers;
+    band_tile_entry *cache;	/* most recently used first */
+    ulong cache_used;
+};
+
+static char *
+band_copy_name(gs_memory_t *mem, const char *name)
+{
+    uint len = strnlen(name, gp_file_name_sizeof - 1);
+    char *copy = (char *)gs_alloc_bytes(mem, len + 1, "band_copy_name");
+
+    if (copy != NULL) {
+        memcpy(copy, name, len);
+        copy[len] = 0;
+    }
+    return copy;
+}
+
+static void
+band_free_page(gx_device_band *bdev)
+{
+    band_page *page = bdev->page;
+    gs_memory_t *mem = bdev->memory->non_gc_memory;
+    band_tile_entry *entry;
+    int i;
+
+    if (page == NULL)
+        return;
+    bdev->page = NULL;
+    while ((entry = page->cache) != NULL) {
+        page->cache = entry->next;
+        gs_free_object(mem, entry->data, "band_free_page(tile)");
+        gs_free_object(mem, entry, "band_free_page(entry)");
+    }
+    /* The workers share the reader's icc_table, so they go first. */
+    for (i = page->num_workers - 1; i > 0; i--)
+        teardown_device_and_mem_for_thread(page->workers[i], NULL, false);
+    if (page->num_workers > 0)
+        teardown_device_and_mem_for_thread(page->workers[0], NULL, true);
+    if (page->cfile != NULL)
+        page->io_procs->fclose(page->cfile, page->cfname, true);
+    if (page->bfile != NULL)
+        page->io_procs->fclose(page->bfile, page->bfname, true);
+    gs_free_object(mem, page->cfname, "band_free_page(cfname)");
+    gs_free_object(mem, page->bfname, "band_free_page(bfname)");
+    gs_free_object(mem, page->workers, "band_free_page(workers)");
+    gs_free_object(mem, page, "band_free_page");
+}
+
+/*
+ * Keep the page just written, as gdev_prn_output_page_aux does for
+ * background printing: take over the band files and give them to a
+ * reader device, then start a new clist for the next page.
+ */
+static int
+band_keep_page(gx_device_band *bdev)
+{
+    gx_device *dev = (gx_device *)bdev;
+    gx_device_clist_common *cdev = (gx_device_clist_common *)dev;
+    gs_memory_t *mem = dev->memory->non_gc_memory;
+    band_page *page;
+    gx_device *reader;
+    int code;
+
+    band_free_page(bdev);
+    if (!PRINTER_IS_CLIST((gx_device_printer *)dev))
+        return_error(gs_error_rangecheck);
+    if ((code = clist_close_writer_and_init_reader((gx_device_clist *)dev)) < 0)
+        return code;
+
+    page = (band_page *)gs_alloc_bytes(mem, sizeof(band_page), "band_keep_page");
+    if (page == NULL)
+        return_error(gs_error_VMerror);
+    memset(page, 0, sizeof(*page));
+    bdev->page = page;
+    page->max_workers = max(bdev->num_render_threads_requested, 1);
+    page->workers = (gx_device **)gs_alloc_bytes(mem,
+                        page->max_workers * sizeof(gx_device *),
+                        "band_keep_page(workers)");
+    page->cfname = band_copy_name(mem, cdev->page_info.cfname);
+    page->bfname = band_copy_name(mem, cdev->page_info.bfname);
+    page->cfile = cdev->page_info.cfile;
+    page->bfile = cdev->page_info.bfile;
+    page->io_procs = cdev->page_info.io_procs;
+    cdev->page_info.cfile = cdev->page_info.bfile = NULL;
+
+    if (page->workers == NULL || page->cfname == NULL || page->bfname == NULL)
+        reader = NULL;
+    else
+        reader = setup_device_and_mem_for_thread(dev->memory->thread_safe_memory,
+                                                 dev, true, NULL);
+    if (reader != NULL) {
+        /* Tiles are split between threads here, not by the clist. */
+        ((gx_device_printer *)reader)->num_render_threads_requested = 0;
+        page->workers[0] = reader;
+        page->num_workers = 1;
+    } else
+        band_free_page(bdev);
+
+    /* The next page goes to new band files. */
+    gs_free_object(mem, cdev->cache_chunk, "band_keep_page(cache_chunk)");
+    cdev->cache_chunk = NULL;
+    code = clist_open(dev);
+    if (code >= 0 && reader == NULL)
+        code = gs_note_error(gs_error_VMerror);
+    return code;
+}
+
+static int
+band_output_page(gx_device *dev, int num_copies, int flush)
+{
+    gx_device_band *bdev = (gx_device_band *)dev;
+    void *handle = bdev->memory->gs_lib_ctx->caller_handle;
+    int code = 0, ecode;
+
+    if (!bdev->KeepPage)
+        return gdev_prn_bg_output_page(dev, num_copies, flush);
+
+    if (num_copies > 0) {
+        code = band_check_structure(bdev);
+        if (code < 0)
+            return code;
+        code = (*bdev->callback->band_page_begin)(handle, dev,
+                    dev->width, dev->height, dev->color_info.num_components);
+        if (code < 0)
+            return_error(code);
+        code = band_keep_page(bdev);
+        ecode = (*bdev->callback->band_page_end)(handle, dev,
+                                                 code < 0 ? code : 0);
+        if (code >= 0 && ecode < 0)
+            code = gs_note_error(ecode);
+    }
+    if (PRINTER_IS_CLIST((gx_device_printer *)dev)) {
+        ecode = clist_finish_page(dev, flush);
+        if (code >= 0)
+            code = ecode;
+    }
+    if (code < 0)
+        return code;
+    return gx_finish_output_page(dev, num_copies, flush);
+}
+
+static int
+band_close(gx_device *dev)
+{
+    band_free_page((gx_device_band *)dev);
+    return gdev_prn_close(dev);
+}
+
+/* Find a tile in the cache and move it to the front. */
+static band_tile_entry *
+band_cache_find(band_page *page, const band_tile *tile)
+{
+    band_tile_entry **pprev = &page->cache;
+    band_tile_entry *entry;
+
+    for (; (entry = *pprev) != NULL; pprev = &entry->next) {
+        if (entry->x == tile->x && entry->y == tile->y &&
+            entry->width == tile->width && entry->height == tile->height &&
+            entry->scale == tile->scale) {
+            *pprev = entry->next;
+            entry->next = page->cache;
+            page->cache = entry;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Add a rendered tile to the cache, dropping the least recently used. */
+static void
+band_cache_add(gx_device_band *bdev, const band_tile *tile, int bpp)
+{
+    band_page *page = bdev->page;
+    gs_memory_t *mem = bdev->memory->non_gc_memory;
+    uint row_size = tile->width * bpp;
+    uint size = row_size * tile->height;
+    band_tile_entry *entry, **pprev;
+    int y;
+
+    if (size > (uint)bdev->TileCacheSize || band_cache_find(page, tile) != NULL)
+        return;
+    while (page->cache != NULL && page->cache_used + size > (ulong)bdev->TileCacheSize) {
+        for (pprev = &page->cache; (*pprev)->next != NULL; pprev = &(*pprev)->next)
+            DO_NOTHING;
+        entry = *pprev;
+        *pprev = NULL;
+        page->cache_used -= entry->size;
+        gs_free_object(mem, entry->data, "band_cache_add(tile)");
+        gs_free_object(mem, entry, "band_cache_add(entry)");
+    }
+    entry = (band_tile_entry *)gs_alloc_bytes(mem, sizeof(band_tile_entry),
+                                              "band_cache_add(entry)");
+    if (entry == NULL)
+        return;
+    entry->data = gs_alloc_bytes(mem, size, "band_cache_add(tile)");
+    if (entry->data == NULL) {
+        gs_free_object(mem, entry, "band_cache_add(entry)");
+        return;
+    }
+    for (y = 0; y < tile->height; y++)
+        memcpy(entry->data + y * row_size, tile->data + y * tile->raster,
+               row_size);
+    entry->x = tile->x;
+    entry->y = tile->y;
+    entry->width = tile->width;
+    entry->height = tile->height;
+    entry->scale = tile->scale;
+    entry->size = size;
+    entry->next = page->cache;
+    page->cache = entry;
+    page->cache_used += size;
+}
+
+/* Average scale x scale blocks of rows of width pixels into one row. */
+static void
+band_reduce_row(byte *out, const byte *in, uint raster, int width, int rows,
+                int scale, int bpp)
+{
+    int x, c, i, j;
+
+    for (x = 0; x < width; x += scale) {
+        int cols = min(scale, width - x);
+        int n = cols * rows;
+
+        for (c = 0; c < bpp; c++) {
+            const byte *p = in + x * bpp + c;
+            uint sum = 0;
+
+            for (j = 0; j < rows; j++, p += raster)
+                for (i = 0; i < cols; i++)
+                    sum += p[i * bpp];
+            *out++ = (byte)((sum + n / 2) / n);
+        }
+    }
+}
+
+/* Render one tile with dev, a clist reader of the page. */
+static int
+band_render_tile(gx_device *dev, band_tile *tile, int bpp)
+{
+    int scale = tile->scale;
+    int x = tile->x * scale;
+    int width = min(tile->width * scale, dev->width - x);
+    uint raster = width * bpp;
+    byte *buf = NULL;
+    gs_get_bits_params_t params;
+    gs_int_rect rect;
+    int y, code = 0;
+
+    if (scale > 1) {
+        buf = gs_alloc_bytes(dev->memory, raster * scale, "band_render_tile");
+        if (buf == NULL)
+            return_error(gs_error_VMerror);
+    }
+    rect.p.x = x;
+    rect.q.x = x + width;
+    for (y = 0; y < tile->height; y++) {
+        byte *out = tile->data + y * tile->raster;
+
+        rect.p.y = (tile->y + y) * scale;
+        rect.q.y = min(rect.p.y + scale, dev->height);
+        params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_CHUNKY |
+                         GB_RETURN_COPY | GB_ALIGN_ANY | GB_OFFSET_0 |
+                         GB_RASTER_SPECIFIED;
+        params.data[0] = (scale > 1 ? buf : out);
+        params.x_offset = 0;
+        params.raster = (scale > 1 ? raster : tile->raster);
+        code = dev_proc(dev, get_bits_rectangle)(dev, &rect, &params, NULL);
+        if (code < 0)
+            break;
+        if (scale > 1)
+            band_reduce_row(out, buf, raster, width, rect.q.y - rect.p.y,
+                            scale, bpp);
+    }
+    gs_free_object(dev->memory, buf, "band_render_tile");
+    return code;
+}
+
+/* The tiles still to be rendered, shared by the rendering threads. */
+typedef struct band_tile_job_s {
+    band_tile *tiles;
+    const int *todo;
+    int num_todo;
+    int next;
+    int bpp;
+    int code;
+    gx_monitor_t *lock;
+} band_tile_job;
+
+typedef struct band_tile_worker_s {
+    band_tile_job *job;
+    gx_device *dev;
+    gp_thread_id thread;
+} band_tile_worker;
+
+static void
+band_tile_thread(void *arg)
+{
+    band_tile_worker *worker = (band_tile_worker *)arg;
+    band_tile_job *job = worker->job;
+    int i, code;
+
+    for (;;) {
+        gx_monitor_enter(job->lock);
+        i = (job->code < 0 || job->next >= job->num_todo ? -1 :
+             job->todo[job->next++]);
+        gx_monitor_leave(job->lock);
+        if (i < 0)
+            break;
+        code = band_render_tile(worker->dev, &job->tiles[i], job->bpp);
+        if (code < 0) {
+            gx_monitor_enter(job->lock);
+            if (job->code >= 0)
+                job->code = code;
+            gx_monitor_leave(job->lock);
+        }
+    }
+}
+
+int
+gdev_band_render_tiles(gx_device *dev, band_tile *tiles, int count)
+{
+    gx_device_band *bdev;
+    gs_memory_t *mem;
+    band_page *page;
+    gx_device *reader;
+    band_tile_job job;
+    band_tile_worker *workers = NULL;
+    int *todo;
+    int bpp, num_threads, i;
+    bool reducible;
+
+    /* Look past subclasses, and past a compositor (such as the pdf14
+     * device while a page with transparency is output) to its target. */
+    for (;;) {
+        gxdso_device_child_request req;
+
+        while (dev->child)
+            dev = dev->child;
+        req.target = dev;
+        req.n = 0;
+        if (dev_proc(dev, dev_spec_op)(dev, gxdso_device_child, &req,
+                                       sizeof(req)) <= 0 ||
+            req.target == NULL || req.target == dev)
+            break;
+        dev = req.target;
+    }
+    bdev = (gx_device_band *)dev;
+    if (dev_proc(dev, output_page) != band_output_page || bdev->page == NULL)
+        return_error(gs_error_undefined);
+    mem = dev->memory->non_gc_memory;
+    page = bdev->page;
+    reader = page->workers[0];
+    bpp = reader->color_info.depth >> 3;
+    /* Only 8 bit samples can be averaged. */
+    reducible = (reader->color_info.depth == 8 * reader->color_info.num_components);
+    if (count < 0 || (reader->color_info.depth & 7) != 0)
+        return_error(gs_error_rangecheck);
+    for (i = 0; i < count; i++) {
+        const band_tile *tile = &tiles[i];
+        int scale = tile->scale;
+
+        if (scale < 1 || (scale > 1 && !reducible) ||
+            tile->x < 0 || tile->y < 0 || tile->width <= 0 || tile->height <= 0 ||
+            tile->width > (reader->width + scale - 1) / scale - tile->x ||
+            tile->height > (reader->height + scale - 1) / scale - tile->y ||
+            tile->raster < tile->width * bpp || tile->data == NULL)
+            return_error(gs_error_rangecheck);
+    }
+    if (count == 0)
+        return 0;
+
+    todo = (int *)gs_alloc_bytes(mem, count * sizeof(int), "gdev_band_render_tiles");
+    if (todo == NULL)
+        return_error(gs_error_VMerror);
+    memset(&job, 0, sizeof(job));
+    job.tiles = tiles;
+    job.todo = todo;
+    job.bpp = bpp;
+    for (i = 0; i < count; i++) {
+        band_tile *tile = &tiles[i];
+        band_tile_entry *entry = band_cache_find(page, tile);
+
+        if (entry != NULL) {
+            uint row_size = tile->width * bpp;
+            int y;
+
+            for (y = 0; y < tile->height; y++)
+                memcpy(tile->data + y * tile->raster,
+                       entry->data + y * row_size, row_size);
+        } else
+            todo[job.num_todo++] = i;
+    }
+
+    /* Add rendering threads as they are needed; they live as long as the page. */
+    num_threads = min(page->max_workers, job.num_todo);
+    while (page->num_workers < num_threads) {
+        gx_device *ndev = setup_device_and_mem_for_thread(
+                              dev->memory->thread_safe_memory, reader, false, NULL);
+
+        if (ndev == NULL)
+            break;
+        ((gx_device_printer *)ndev)->num_render_threads_requested = 0;
+        page->workers[page->num_workers++] = ndev;
+    }
+    num_threads = min(page->num_workers, num_threads);
+    if (num_threads > 1) {
+        job.lock = gx_monitor_label(gx_monitor_alloc(mem), "band_tile_job");
+        workers = (band_tile_worker *)gs_alloc_bytes(mem,
+                        num_threads * sizeof(band_tile_worker),
+                        "gdev_band_render_tiles(workers)");
+        if (job.lock == NULL || workers == NULL)
+            num_threads = 1;
+    }
+
+    if (num_threads > 1) {
+        /* The calling thread renders too, with the reader. */
+        for (i = 0; i < num_threads; i++) {
+            workers[i].job = &job;
+            workers[i].dev = page->workers[i];
+            workers[i].thread = NULL;
+        }
+        for (i = 1; i < num_threads; i++) {
+            if (gp_thread_start(band_tile_thread, &workers[i],
+                                &workers[i].thread) < 0) {
+                workers[i].thread = NULL;
+                break;
+            }
+            gp_thread_label(workers[i].thread, "Tile rendering thread");
+        }
+        band_tile_thread(&workers[0]);
+        for (i = 1; i < num_threads; i++)
+            gp_thread_finish(workers[i].thread);
+    } else {
+        for (i = 0; i < job.num_todo && job.code >= 0; i++)
+            job.code = band_render_tile(reader, &tiles[todo[i]], bpp);
+    }
+    if (job.lock != NULL)
+        gx_monitor_free(job.lock);
+    gs_free_object(mem, workers, "gdev_band_render_tiles(workers)");
+
+    if (job.code >= 0) {
+        for (i = 0; i < job.num_todo; i++)
+            band_cache_add(bdev, &tiles[todo[i]], bpp);
+    }
+    gs_free_object(mem, todo, "gdev_band_render_tiles");
+    return job.code;
+}
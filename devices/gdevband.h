@@ -0,0 +1,132 @@
+/* Copyright (C) 2001-2018 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* gdevband.h - callback structure for the band streaming devices */
+
+#ifndef gdevband_INCLUDED
+#  define gdevband_INCLUDED
+
+/*
+ * The band devices (bandgray, bandrgb and bandcmyk) hand each rendered
+ * band of a page straight to the caller, instead of writing a file or
+ * keeping a full page raster.  The callback structure must be provided
+ * by calling the Ghostscript APIs in the following order:
+ *  gsapi_new_instance(&minst, caller_handle);
+ *  gsapi_set_band_callback(minst, callback);
+ *  gsapi_init_with_args(minst, argc, argv);
+ *
+ * The first parameter of all callback functions is the caller_handle
+ * given to gsapi_new_instance().  The second parameter "void *device"
+ * is the address of the Ghostscript band device instance.
+ *
+ * For each page (and each copy of a page) the sequence of callbacks is
+ *  band_page_begin, band_data, band_data, ..., band_page_end
+ * band_data is called once per band, from the top of the page down,
+ * always on the thread that called into Ghostscript, even when the
+ * bands are rendered by several threads (-dNumRenderingThreads=n).
+ *
+ * The data passed to band_data is not copied: it points into the
+ * buffer the band was rendered (and downscaled, with -dDownScaleFactor)
+ * in.  The buffer belongs to the caller until band_data returns, and
+ * is only then recycled to render another band.  A caller that needs
+ * the pixels for longer must copy them before returning.
+ *
+ * Samples are 8 bits per component, chunky (interleaved), in the
+ * order gray, RGB or CMYK.  For gray and RGB, 0 is black; for CMYK,
+ * 0 is no ink.
+ *
+ * Band heights are chosen by the clist (see -dBandHeight and
+ * -dBufferSpace); only the last band of a page may be shorter.
+ * If the page is rendered without a clist, it arrives as one band.
+ *
+ * With -dKeepPage=true a page is not rendered when it is output.
+ * Instead its clist is kept, and band_page_begin and band_page_end are
+ * called with no band_data in between.  Until the next page is output
+ * or the device is closed, any part of the page can then be rendered
+ * with gsapi_render_tiles(), as often as needed, without interpreting
+ * the page again.  This is meant for viewers that pan and zoom a large
+ * page.  Tiles are rendered at integer reductions of the device
+ * resolution, by box-averaging scale x scale blocks of device pixels,
+ * and on up to NumRenderingThreads threads at once.  Recently rendered
+ * tiles are kept in a cache of -dTileCacheSize bytes (0 disables it).
+ * DownScaleFactor does not apply to tiles.
+ */
+
+#define BAND_VERSION_MAJOR 1
+#define BAND_VERSION_MINOR 0
+
+/*
+ * Note that for Windows, the band callback functions are
+ * cdecl, not stdcall.  This differs from those in iapi.h.
+ */
+
+#ifndef band_callback_DEFINED
+# define band_callback_DEFINED
+typedef struct band_callback_s band_callback;
+#endif
+
+struct band_callback_s {
+    /* Size of this structure */
+    /* Used for checking if we have been handed a valid structure */
+    int size;
+
+    /* Major version of this structure  */
+    /* The major version number will change if this structure changes. */
+    int version_major;
+
+    /* Minor version of this structure */
+    int version_minor;
+
+    /* A page is about to be rendered. */
+    /* width and height are those of the (downscaled) page in pixels. */
+    int (*band_page_begin)(void *handle, void *device,
+        int width, int height, int num_components);
+
+    /* A band has been rendered. */
+    /* The band covers rows y to y + height - 1 of the page. */
+    /* raster is the byte count from one row to the next. */
+    int (*band_data)(void *handle, void *device,
+        int y, int height, int raster, const unsigned char *data);
+
+    /* The page is finished. */
+    /* error is 0, or the (negative) error code that stopped the page. */
+    int (*band_page_end)(void *handle, void *device, int error);
+};
+
+#ifndef band_tile_DEFINED
+# define band_tile_DEFINED
+typedef struct band_tile_s band_tile;
+#endif
+
+/* A tile of a kept page, for gsapi_render_tiles(). */
+struct band_tile_s {
+    /* Position and size of the tile in pixels of the reduced page, */
+    /* which is (width + scale - 1) / scale pixels wide, and likewise */
+    /* high, where width and height are those given to band_page_begin. */
+    int x;
+    int y;
+    int width;
+    int height;
+
+    /* Reduction factor, 1 for device resolution. */
+    int scale;
+
+    /* The caller's buffer for the tile, raster bytes per row, in the */
+    /* same format as band_data. */
+    int raster;
+    unsigned char *data;
+};
+
+#endif /* gdevband_INCLUDED */
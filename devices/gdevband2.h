@@ -0,0 +1,48 @@
+/* Copyright (C) 2001-2018 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+
+/* gdevband2.h */
+/* Requires gdevprn.h, gxdownscale.h, gdevband.h */
+
+#ifndef gdevband2_INCLUDED
+#  define gdevband2_INCLUDED
+
+typedef struct gx_device_band_s gx_device_band;
+
+/* The page kept with KeepPage; private to gdevband.c. */
+typedef struct band_page_s band_page;
+
+/* The device descriptor */
+struct gx_device_band_s {
+    gx_device_common;
+    gx_prn_device_common;
+    gx_downscaler_params downscale;
+    band_callback *callback;
+    bool KeepPage;	/* keep the clist for gdev_band_render_tiles */
+    int TileCacheSize;	/* bytes of rendered tiles to keep */
+    band_page *page;	/* the kept page, or NULL */
+};
+
+/*
+ * Render tiles of the page kept by a band device with KeepPage.
+ * dev may also be a device in front of it, such as the current device.
+ * Cached tiles are copied, the rest are rendered from the clist on up
+ * to NumRenderingThreads threads.  Returns gs_error_undefined if dev
+ * is not a band device or has no page, and gs_error_rangecheck if a
+ * tile does not lie within the page.
+ */
+int gdev_band_render_tiles(gx_device *dev, band_tile *tiles, int count);
+
+#endif /* gdevband2_INCLUDED */
@@ -48,8 +48,10 @@
 
 #include "gdevpccm.h"		/* 4-bit PC color */
 #include "gxdevmem.h"
+#include "gxgetbit.h"
 #include "gdevdevn.h"
 #include "gsequivc.h"
+#include "gdevprn.h"
 #include "gdevdsp.h"
 #include "gdevdsp2.h"
 
@@ -166,16 +168,13 @@ public_st_device_display();
 
 static
 ENUM_PTRS_WITH(display_enum_ptrs, gx_device_display *ddev)
-    if (index == 0) {
-        if (ddev->mdev) {
-            return ENUM_OBJ(gx_device_enum_ptr((gx_device *)ddev->mdev));
-        }
-        return 0;
-    }
+    /* mdev may be NULL, but must not end the enumeration. */
+    if (index == 0)
+        return ENUM_OBJ(gx_device_enum_ptr((gx_device *)ddev->mdev));
     else if (index-1 < ddev->devn_params.separations.num_separations)
         ENUM_RETURN(ddev->devn_params.separations.names[index-1].data);
-    else
-        return 0;
+    ENUM_PREFIX(st_device_printer,
+                    1 + ddev->devn_params.separations.num_separations);
 ENUM_PTRS_END
 
 static
@@ -189,6 +188,7 @@ RELOC_PTRS_WITH(display_reloc_ptrs, gx_device_display *ddev)
             RELOC_PTR(gx_device_display, devn_params.separations.names[i].data);
         }
     }
+    RELOC_PREFIX(st_device_printer);
 RELOC_PTRS_END
 
 const gx_device_display gs_display_device =
@@ -197,7 +197,7 @@ const gx_device_display gs_display_device =
                         &st_device_display,
                         INITIAL_WIDTH, INITIAL_HEIGHT,
                         INITIAL_RESOLUTION, INITIAL_RESOLUTION),
-    {0},			/* std_procs */
+    prn_device_body_rest_(NULL),	/* printer part, for DISPLAY_BANDED */
     NULL,			/* mdev */
     NULL,			/* callback */
     NULL,			/* pHandle */
@@ -226,6 +226,8 @@ static int display_alloc_bitmap(gx_device_display *, gx_device *);
 static int display_set_color_format(gx_device_display *dev, int nFormat);
 static int display_set_separations(gx_device_display *dev);
 static int display_raster(gx_device_display *dev);
+static int display_alloc_bands(gx_device_display *);
+static int display_render_bands(gx_device_display *);
 
 /* Open the display driver. */
 static int
@@ -254,6 +256,10 @@ display_open(gx_device * dev)
     /* Make sure we have been passed a valid callback structure. */
     if ((ccode = display_check_structure(ddev)) < 0)
         return_error(ccode);
+    if ((ddev->nFormat & DISPLAY_BANDED_MASK) == DISPLAY_BANDED &&
+        (ddev->callback->version_major < DISPLAY_VERSION_MAJOR ||
+         ddev->callback->display_band == NULL))
+        return_error(gs_error_rangecheck);
 
     /* set color info */
     if ((ccode = display_set_color_format(ddev, ddev->nFormat)) < 0)
@@ -283,7 +289,7 @@ display_open(gx_device * dev)
     /* Tell caller the device parameters */
     ccode = (*(ddev->callback->display_size)) (ddev->pHandle, dev,
         dev->width, dev->height, display_raster(ddev), ddev->nFormat,
-        ddev->mdev->base);
+        ddev->mdev ? ddev->mdev->base : NULL);
     if (ccode < 0) {
         display_free_bitmap(ddev);
         (*(ddev->callback->display_close))(ddev->pHandle, dev);
@@ -330,6 +336,20 @@ display_output_page(gx_device * dev, int copies, int flush)
         return gs_error_Fatal;
     display_set_separations(ddev);
 
+    if (PRINTER_IS_CLIST((gx_device_printer *)ddev)) {
+        /* DISPLAY_BANDED: render the bands, then start the next page
+         * (or keep this one, for copypage) as gdevprn does.
+         */
+        int ecode;
+
+        code = display_render_bands(ddev);
+        ecode = clist_finish_page(dev, flush);
+        if (code < 0)
+            return code;
+        if (ecode < 0)
+            return ecode;
+    }
+
     while(dev->parent)
         dev = dev->parent;
 
@@ -820,7 +840,9 @@ display_get_params(gx_device * dev, gs_param_list * plist)
         (code = param_write_int(plist,
             "DisplayFormat", &ddev->nFormat)) < 0 ||
         (code = param_write_float(plist,
-            "DisplayResolution", &ddev->HWResolution[1])) < 0);
+            "DisplayResolution", &ddev->HWResolution[1])) < 0 ||
+        (code = param_write_int(plist,
+            "NumRenderingThreads", &ddev->num_render_threads_requested)) < 0);
     if (code >= 0 &&
         (ddev->nFormat & DISPLAY_COLORS_MASK) == DISPLAY_COLORS_SEPARATION)
         code = devn_get_params(dev, plist, &ddev->devn_params,
@@ -844,6 +866,7 @@ display_put_params(gx_device * dev, gs_param_list * plist)
 
     int old_width = dev->width;
     int old_height = dev->height;
+    bool old_page_uses_transparency = dev->page_uses_transparency;
     int old_format = ddev->nFormat;
     void *old_handle = ddev->pHandle;
 
@@ -1001,6 +1024,21 @@ display_put_params(gx_device * dev, gs_param_list * plist)
             break;
     }
 
+    /* Used by DISPLAY_BANDED, when each page is rendered. */
+    switch (code = param_read_int(plist, "NumRenderingThreads",
+                                  &ddev->num_render_threads_requested)) {
+        case 0:
+            if (ddev->num_render_threads_requested >= 0)
+                break;
+            ecode = gs_error_rangecheck;
+            goto nrte;
+        default:
+            ecode = code;
+          nrte:param_signal_error(plist, "NumRenderingThreads", ecode);
+        case 1:
+            break;
+    }
+
     if (ecode >= 0 &&
             (ddev->nFormat & DISPLAY_COLORS_MASK) == DISPLAY_COLORS_SEPARATION) {
         /* Use utility routine to handle devn parameters */
@@ -1088,9 +1126,18 @@ display_put_params(gx_device * dev, gs_param_list * plist)
         /* tell caller about the new size */
         if ((*ddev->callback->display_size)(ddev->pHandle, dev,
             dev->width, dev->height, display_raster(ddev),
-            ddev->nFormat, ddev->mdev->base) < 0)
+            ddev->nFormat, ddev->mdev ? ddev->mdev->base : NULL) < 0)
             return_error(gs_error_rangecheck);
     }
+    else if (is_open && PRINTER_IS_CLIST((gx_device_printer *)ddev) &&
+        old_page_uses_transparency != dev->page_uses_transparency) {
+        /* As for a printer, make room in the bands for the transparency
+         * buffers.  Like setpagedevice, this starts a new page.
+         */
+        code = display_alloc_bitmap(ddev, dev);
+        if (code < 0)
+            return code;
+    }
 
     return 0;
 }
@@ -1109,6 +1156,17 @@ display_finish_copydevice(gx_device *dev, const gx_device *from_dev)
     ddev->pBitmap = NULL;
     ddev->ulBitmapSize = 0;
 
+    /* A copy of a DISPLAY_BANDED device gets our procs back, but not
+     * the clist.
+     */
+    if (PRINTER_IS_CLIST((gx_device_printer *)ddev)) {
+        ddev->procs = ddev->orig_procs;
+        memset(ddev->skip, 0, sizeof(ddev->skip));
+        ddev->buffer_space = 0;
+        ddev->buf = NULL;
+    }
+    ddev->orig_procs.open_device = 0;
+
     return 0;
 }
 
@@ -1269,8 +1327,17 @@ static int display_check_structure(gx_device_display *ddev)
         if (ddev->callback->version_minor > DISPLAY_VERSION_MINOR_V1)
             return_error(gs_error_rangecheck);
     }
-    else {
+    else if (ddev->callback->size == sizeof(struct display_callback_v2_s)) {
         /* V2 structure with added display_separation callback */
+        if (ddev->callback->version_major != DISPLAY_VERSION_MAJOR_V2)
+            return_error(gs_error_rangecheck);
+
+        /* complain if caller asks for newer features */
+        if (ddev->callback->version_minor > DISPLAY_VERSION_MINOR_V2)
+            return_error(gs_error_rangecheck);
+    }
+    else {
+        /* V3 structure with added display_band callback */
         if (ddev->callback->size != sizeof(display_callback))
             return_error(gs_error_rangecheck);
 
@@ -1304,6 +1371,8 @@ display_free_bitmap(gx_device_display * ddev)
 {
     if (ddev->callback == NULL)
         return;
+    if (PRINTER_IS_CLIST((gx_device_printer *)ddev))
+        gdev_prn_free_memory((gx_device *)ddev);
     if (ddev->pBitmap) {
         if (ddev->callback->display_memalloc
             && ddev->callback->display_memfree
@@ -1368,6 +1437,9 @@ display_alloc_bitmap(gx_device_display * ddev, gx_device * param_dev)
     /* free old bitmap (if any) */
     display_free_bitmap(ddev);
 
+    if ((ddev->nFormat & DISPLAY_BANDED_MASK) == DISPLAY_BANDED)
+        return display_alloc_bands(ddev);
+
     /* allocate a memory device for rendering */
     mdproto = gdev_mem_device_for_bits(ddev->color_info.depth);
     if (mdproto == 0)
@@ -1441,6 +1513,142 @@ display_alloc_bitmap(gx_device_display * ddev, gx_device * param_dev)
     return ccode;
 }
 
+/*
+ * DISPLAY_BANDED: instead of a page bitmap, the device records the page
+ * in a clist, as a printer does when banding.  At output_page the bands
+ * are rendered, on NumRenderingThreads threads if requested, and passed
+ * in order to display_band.  Colors are already encoded by this device,
+ * so a band has the layout that rows of the page bitmap would have,
+ * apart from the row alignment.
+ */
+
+/* What a rendering thread leaves behind for display_band_output. */
+typedef struct display_band_buffer_s {
+    const byte *data;
+    int raster;
+    int y;
+    int height;
+} display_band_buffer_t;
+
+static int
+display_band_init_buffer(void *arg, gx_device *dev, gs_memory_t *mem,
+    int w, int h, void **pbuffer)
+{
+    display_band_buffer_t *buffer;
+
+    buffer = (display_band_buffer_t *)gs_alloc_bytes(mem,
+        sizeof(display_band_buffer_t), "display_band_init_buffer");
+    *pbuffer = (void *)buffer;
+    if (buffer == NULL)
+        return_error(gs_error_VMerror);
+    memset(buffer, 0, sizeof(*buffer));
+    return 0;
+}
+
+static void
+display_band_free_buffer(void *arg, gx_device *dev, gs_memory_t *mem,
+    void *buffer)
+{
+    gs_free_object(mem, buffer, "display_band_init_buffer");
+}
+
+/* Runs on the rendering thread.  bdev holds the rendered band, and is
+ * left alone until display_band_output has run.
+ */
+static int
+display_band_process(void *arg, gx_device *dev, gx_device *bdev,
+    const gs_int_rect *rect, void *buffer_)
+{
+    display_band_buffer_t *buffer = (display_band_buffer_t *)buffer_;
+    gs_get_bits_params_t params;
+    gs_int_rect my_rect;
+    int code;
+
+    my_rect.p.x = 0;
+    my_rect.p.y = 0;
+    my_rect.q.x = rect->q.x - rect->p.x;
+    my_rect.q.y = rect->q.y - rect->p.y;
+    params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_CHUNKY |
+                     GB_RETURN_POINTER | GB_ALIGN_ANY | GB_OFFSET_0 |
+                     GB_RASTER_ANY;
+    code = dev_proc(bdev, get_bits_rectangle)(bdev, &my_rect, &params, NULL);
+    if (code < 0)
+        return code;
+
+    buffer->data = params.data[0];
+    buffer->raster = gx_device_raster(bdev, true);
+    buffer->y = rect->p.y;
+    buffer->height = my_rect.q.y;
+    return 0;
+}
+
+/* Runs on the main thread, in band order. */
+static int
+display_band_output(void *arg, gx_device *dev, void *buffer_)
+{
+    gx_device_display *ddev = (gx_device_display *)arg;
+    display_band_buffer_t *buffer = (display_band_buffer_t *)buffer_;
+    int code;
+
+    dev = (gx_device *)ddev;
+    while(dev->parent)
+        dev = dev->parent;
+
+    code = (*ddev->callback->display_band)(ddev->pHandle, dev,
+        buffer->y, buffer->height, buffer->raster,
+        (unsigned char *)buffer->data);
+    if (code < 0)
+        return_error(code);
+    return 0;
+}
+
+/* Render the page recorded in the clist, band by band. */
+static int
+display_render_bands(gx_device_display *ddev)
+{
+    gx_process_page_options_t process = { 0 };
+
+    process.init_buffer_fn = display_band_init_buffer;
+    process.free_buffer_fn = display_band_free_buffer;
+    process.process_fn = display_band_process;
+    process.output_fn = display_band_output;
+    process.arg = ddev;
+
+    return dev_proc(ddev, process_page)((gx_device *)ddev, &process);
+}
+
+static int
+display_alloc_bands(gx_device_display *ddev)
+{
+    gx_device *dev = (gx_device *)ddev;
+    int ccode;
+
+    /* BandHeight, BufferSpace and NumRenderingThreads apply as for
+     * a printer.  gdev_prn_allocate_memory installs the clist procs,
+     * keeping ours for everything but drawing.
+     */
+    ddev->space_params.banding_type = BandingAlways;
+    ccode = gdev_prn_allocate_memory(dev, NULL, 0, 0);
+    if (ccode < 0)
+        return ccode;
+    set_dev_proc(dev, sync_output, display_sync_output);
+    set_dev_proc(dev, finish_copydevice, display_finish_copydevice);
+
+    /* erase the page, as for the bitmap */
+    {
+        int i;
+        gx_color_value cv[GX_DEVICE_COLOR_MAX_COMPONENTS];
+        for (i=0; i<GX_DEVICE_COLOR_MAX_COMPONENTS; i++)
+            cv[i] = (ddev->color_info.polarity == GX_CINFO_POLARITY_ADDITIVE)
+                ? gx_max_color_value : 0;
+        dev_proc(ddev, fill_rectangle)((gx_device *)ddev,
+                 0, 0, ddev->width, ddev->height,
+                 dev_proc(ddev, encode_color)((gx_device *)ddev, cv));
+    }
+
+    return 0;
+}
+
 static int
 display_set_separations(gx_device_display *dev)
 {
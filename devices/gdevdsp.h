@@ -53,11 +53,29 @@
  * If opening the device fails, you might see the following:
  *  open, presize, memalloc, memfree, close
  *
+ * With DISPLAY_BANDED (V3 and later), the device keeps no page
+ * raster.  The page is recorded in a clist and rendered band by
+ * band at showpage, and each band is passed to display_band in
+ * order from the first row down, so memory use is bounded by the
+ * band size rather than the page size.  display_size is then given
+ * a NULL pimage, memalloc, memfree and update are not used, and a
+ * typical sequence would be
+ *  open, presize, size, sync, band, band, ..., page
+ *  preclose, close
+ * The following parameters are also supported in banded mode:
+ * -dNumRenderingThreads=0                int
+ *    Render bands on this many threads.  display_band is still
+ *    called in order, on the thread that called Ghostscript.
+ * -dBandHeight and -dBufferSpace
+ *    Choose the band size, as for the printer devices.
  */
 
-#define DISPLAY_VERSION_MAJOR 2
+#define DISPLAY_VERSION_MAJOR 3
 #define DISPLAY_VERSION_MINOR 0
 
+#define DISPLAY_VERSION_MAJOR_V2 2 /* before banded mode was added */
+#define DISPLAY_VERSION_MINOR_V2 0
+
 #define DISPLAY_VERSION_MAJOR_V1 1 /* before separation format was added */
 #define DISPLAY_VERSION_MINOR_V1 0
 
@@ -144,6 +162,15 @@ typedef enum {
 } DISPLAY_FORMAT_ROW_ALIGN;
 #define DISPLAY_ROW_ALIGN_MASK 0x00700000L
 
+/* Define whether the device keeps a full page raster, or renders
+ * the page in bands through display_band (V3 and later).
+ */
+typedef enum {
+    DISPLAY_FULLPAGE = (0<<24),
+    DISPLAY_BANDED   = (1<<24)
+} DISPLAY_FORMAT_BANDED;
+#define DISPLAY_BANDED_MASK 0x01000000L
+
 #ifndef display_callback_DEFINED
 #define display_callback_DEFINED
 typedef struct display_callback_s display_callback;
@@ -238,6 +265,44 @@ struct display_callback_s {
         int component, const char *component_name,
         unsigned short c, unsigned short m,
         unsigned short y, unsigned short k);
+
+    /* Added in V3 */
+    /* With DISPLAY_BANDED, a band of the page has been rendered.
+     * The band covers rows y to y + height - 1 of the page, laid out
+     * as they would be in the full page raster, but raster bytes
+     * apart, which may differ from the raster given to display_size.
+     * pimage points into the buffer the band was rendered in and is
+     * only valid until this function returns.
+     * GS must only use this callback if version_major >= 3.
+     * This function pointer may be set to NULL if DISPLAY_BANDED
+     * is not used.
+     */
+    int (*display_band)(void *handle, void *device,
+        int y, int height, int raster, unsigned char *pimage);
+};
+
+/* This is the V2 structure, before banded mode was added */
+struct display_callback_v2_s {
+    int size;
+    int version_major;
+    int version_minor;
+    int (*display_open)(void *handle, void *device);
+    int (*display_preclose)(void *handle, void *device);
+    int (*display_close)(void *handle, void *device);
+    int (*display_presize)(void *handle, void *device,
+        int width, int height, int raster, unsigned int format);
+    int (*display_size)(void *handle, void *device, int width, int height,
+        int raster, unsigned int format, unsigned char *pimage);
+    int (*display_sync)(void *handle, void *device);
+    int (*display_page)(void *handle, void *device, int copies, int flush);
+    int (*display_update)(void *handle, void *device, int x, int y,
+        int w, int h);
+    void *(*display_memalloc)(void *handle, void *device, unsigned long size);
+    int (*display_memfree)(void *handle, void *device, void *mem);
+    int (*display_separation)(void *handle, void *device,
+        int component, const char *component_name,
+        unsigned short c, unsigned short m,
+        unsigned short y, unsigned short k);
 };
 
 /* This is the V1 structure, before separation format was added */
@@ -261,5 +326,6 @@ struct display_callback_v1_s {
 };
 
 #define DISPLAY_CALLBACK_V1_SIZEOF sizeof(struct display_callback_v1_s)
+#define DISPLAY_CALLBACK_V2_SIZEOF sizeof(struct display_callback_v2_s)
 
 #endif /* gdevdsp_INCLUDED */
@@ -14,6 +14,7 @@
 */
 
 /* gdevdsp2.c */
+/* Requires gdevprn.h */
 
 #ifndef gdevdsp2_INCLUDED
 #  define gdevdsp2_INCLUDED
@@ -31,9 +32,12 @@ typedef struct gx_device_display_s gx_device_display;
         gs_devn_params devn_params;\
         equivalent_cmyk_color_params equiv_cmyk_colors
 
-/* The device descriptor */
+/* The device descriptor.  The printer part is only used for
+ * DISPLAY_BANDED, where the device records each page in a clist.
+ */
 struct gx_device_display_s {
     gx_device_common;
+    gx_prn_device_common;
     gx_device_display_common;
 };
 
@@ -22,6 +22,7 @@
 #include "sdct.h"
 #include "sjpeg.h"
 #include "gxdownscale.h"
+#include "gxgetbit.h"
 
 /* Structure for the JPEG-writing device. */
 typedef struct gx_device_jpeg_s {
@@ -412,76 +413,53 @@ jpeg_get_initial_matrix(gx_device *dev, gs_matrix *pmat)
 
 }
 
-/* Send the page to the file. */
+/*
+ * Set up the DCT encoder state for an image of the given size.  On
+ * failure the IJG compressor has already been destroyed.
+ */
 static int
-jpeg_print_page(gx_device_printer * pdev, FILE * prn_stream)
+jpeg_create_encoder(gx_device_jpeg *jdev, gs_memory_t *mem,
+                    jpeg_compress_data *jcdp, stream_DCT_state *state,
+                    uint width, uint height, bool icc)
 {
-    gx_device_jpeg *jdev = (gx_device_jpeg *) pdev;
-    gs_memory_t *mem = pdev->memory;
-    int line_size = gdev_mem_bytes_per_scan_line((gx_device *) pdev);
-    byte *in = gs_alloc_bytes(mem, line_size, "jpeg_print_page(in)");
-    jpeg_compress_data *jcdp = gs_alloc_struct_immovable(mem, jpeg_compress_data,
-      &st_jpeg_compress_data, "jpeg_print_page(jpeg_compress_data)");
-    byte *fbuf = 0;
-    uint fbuf_size;
-    byte *jbuf = 0;
-    uint jbuf_size;
-    int lnum;
+    gx_device_printer *pdev = (gx_device_printer *)jdev;
     int code;
-    stream_DCT_state state;
-    stream fstrm, jstrm;
-    gx_downscaler_t ds;
-
-    if (jcdp == 0 || in == 0) {
-        code = gs_note_error(gs_error_VMerror);
-        goto fail;
-    }
-    code = gx_downscaler_init(&ds, (gx_device *)jdev, 8, 8,
-                              jdev->color_info.depth/8, jdev->downscale.downscale_factor, 0, NULL, 0);
-    if (code < 0) {
-        gs_free_object(mem, jcdp, "jpeg_print_page(jpeg_compress_data)");
-        jcdp = NULL;
-        goto fail;
-    }
 
     /* Create the DCT encoder state. */
     jcdp->templat = s_DCTE_template;
-    s_init_state((stream_state *)&state, &jcdp->templat, 0);
-    if (state.templat->set_defaults) {
-        state.memory = mem;
-        (*state.templat->set_defaults) ((stream_state *) & state);
-        state.memory = NULL;
+    s_init_state((stream_state *)state, &jcdp->templat, 0);
+    if (state->templat->set_defaults) {
+        state->memory = mem;
+        (*state->templat->set_defaults) ((stream_state *) state);
+        state->memory = NULL;
     }
-    state.QFactor = 1.0;	/* disable quality adjustment in zfdcte.c */
-    state.ColorTransform = 1;	/* default for RGB */
+    state->QFactor = 1.0;	/* disable quality adjustment in zfdcte.c */
+    state->ColorTransform = 1;	/* default for RGB */
     /* We insert no markers, allowing the IJG library to emit */
     /* the format it thinks best. */
-    state.NoMarker = true;	/* do not insert our own Adobe marker */
-    state.Markers.data = 0;
-    state.Markers.size = 0;
-    state.data.compress = jcdp;
+    state->NoMarker = true;	/* do not insert our own Adobe marker */
+    state->Markers.data = 0;
+    state->Markers.size = 0;
+    state->data.compress = jcdp;
     /* Add in ICC profile */
-    state.icc_profile = NULL; /* In case it is not set here */
-    if (pdev->icc_struct != NULL && pdev->icc_struct->device_profile[0] != NULL) {
+    state->icc_profile = NULL; /* In case it is not set here */
+    if (icc && pdev->icc_struct != NULL && pdev->icc_struct->device_profile[0] != NULL) {
         cmm_profile_t *icc_profile = pdev->icc_struct->device_profile[0];
         if (icc_profile->num_comps == pdev->color_info.num_components &&
             !(pdev->icc_struct->usefastcolor)) {
-            state.icc_profile = icc_profile;
+            state->icc_profile = icc_profile;
         }
     }
-    /* We need state.memory for gs_jpeg_create_compress().... */
-    jcdp->memory = state.jpeg_memory = state.memory = mem;
-    if ((code = gs_jpeg_create_compress(&state)) < 0)
-    {
-        gx_downscaler_fin(&ds);
-        goto fail;
-    }
+    /* We need state->memory for gs_jpeg_create_compress().... */
+    jcdp->memory = state->jpeg_memory = state->memory = mem;
+    if ((code = gs_jpeg_create_compress(state)) < 0)
+        return code;
     /* ....but we need it to be NULL so we don't try to free
      * the stack based state...
      */
-    state.memory = NULL;
-    jcdp->cinfo.image_width = gx_downscaler_scale(pdev->width, jdev->downscale.downscale_factor);
-    jcdp->cinfo.image_height = gx_downscaler_scale(pdev->height, jdev->downscale.downscale_factor);
+    state->memory = NULL;
+    jcdp->cinfo.image_width = width;
+    jcdp->cinfo.image_height = height;
     switch (pdev->color_info.depth) {
         case 32:
             jcdp->cinfo.input_components = 4;
@@ -497,33 +475,374 @@ jpeg_print_page(gx_device_printer * pdev, FILE * prn_stream)
             break;
     }
     /* Set compression parameters. */
-    if ((code = gs_jpeg_set_defaults(&state)) < 0)
-        goto done;
+    if ((code = gs_jpeg_set_defaults(state)) < 0)
+        goto fail;
     if (jdev->JPEGQ > 0) {
-        code = gs_jpeg_set_quality(&state, jdev->JPEGQ, TRUE);
+        code = gs_jpeg_set_quality(state, jdev->JPEGQ, TRUE);
         if (code < 0)
-            goto done;
+            goto fail;
     } else if (jdev->QFactor > 0.0) {
-        code = gs_jpeg_set_linear_quality(&state,
+        code = gs_jpeg_set_linear_quality(state,
                                           (int)(min(jdev->QFactor, 100.0)
                                                 * 100.0 + 0.5),
                                           TRUE);
         if (code < 0)
-            goto done;
+            goto fail;
     }
     jcdp->cinfo.restart_interval = 0;
     jcdp->cinfo.density_unit = 1;	/* dots/inch (no #define or enum) */
     jcdp->cinfo.X_density = (UINT16)pdev->HWResolution[0];
     jcdp->cinfo.Y_density = (UINT16)pdev->HWResolution[1];
-    /* Create the filter. */
     /* Make sure we get at least a full scan line of input. */
-    state.scan_line_size = jcdp->cinfo.input_components *
+    state->scan_line_size = jcdp->cinfo.input_components *
         jcdp->cinfo.image_width;
     jcdp->templat.min_in_size =
-        max(s_DCTE_template.min_in_size, state.scan_line_size);
+        max(s_DCTE_template.min_in_size, state->scan_line_size);
     /* Make sure we can write the user markers in a single go. */
     jcdp->templat.min_out_size =
-        max(s_DCTE_template.min_out_size, state.Markers.size);
+        max(s_DCTE_template.min_out_size, state->Markers.size);
+    return 0;
+  fail:
+    gs_jpeg_destroy(state);
+    return code;
+}
+
+/* ------ Banded output ------ */
+
+/*
+ * When the page is rendered by several threads, each band is encoded on
+ * its rendering thread as a complete JPEG of its own.  Bands start on an
+ * MCU row boundary, so each band's entropy coded data is exactly one
+ * restart interval of the page: the main thread writes the tables from
+ * the first band with the page height and a DRI marker, and then the
+ * scan data of every band separated by RSTn markers.
+ */
+
+/* Marker codes, as in the IJG library's jcmarker.c */
+#define M_SOF0 0xc0
+#define M_SOF1 0xc1
+#define M_SOS 0xda
+#define M_DRI 0xdd
+
+typedef struct jpeg_band_arg_s {
+    gx_device_jpeg *dev;
+    FILE *file;
+    int band_height;
+    int mcu_width, mcu_height;	/* in pixels */
+    int restart_interval;	/* in MCUs */
+    int band;			/* next band to output */
+} jpeg_band_arg_t;
+
+typedef struct jpeg_band_buffer_s {
+    stream fstrm;		/* must be first, it is its own state */
+    gs_memory_t *memory;
+    byte *fbuf, *jbuf;
+    uint fbuf_size, jbuf_size;
+    byte *data;			/* the band's JPEG */
+    uint size, len;
+    bool first, last;
+} jpeg_band_buffer_t;
+
+/* Append encoded data to the band's JPEG, growing it as needed. */
+static int
+jpeg_band_write_process(stream_state * st, stream_cursor_read * pr,
+                        stream_cursor_write * ignore_pw, bool last)
+{
+    jpeg_band_buffer_t *buffer = (jpeg_band_buffer_t *)st;
+    uint count = pr->limit - pr->ptr;
+
+    if (buffer->len + count > buffer->size) {
+        uint size = max(buffer->size * 2, buffer->len + count);
+        byte *data = gs_alloc_bytes(buffer->memory, size, "jpeg_band_write_process");
+
+        if (data == NULL)
+            return ERRC;
+        memcpy(data, buffer->data, buffer->len);
+        gs_free_object(buffer->memory, buffer->data, "jpeg_band_write_process");
+        buffer->data = data;
+        buffer->size = size;
+    }
+    memcpy(buffer->data + buffer->len, pr->ptr + 1, count);
+    buffer->len += count;
+    pr->ptr = pr->limit;
+    return 0;
+}
+
+static int
+jpeg_band_init_buffer(void *arg_, gx_device *dev, gs_memory_t *mem, int w, int h, void **pbuffer)
+{
+    jpeg_band_buffer_t *buffer;
+    uint fbuf_size = max(512 /* arbitrary */ , s_DCTE_template.min_out_size);
+    uint jbuf_size = max(s_DCTE_template.min_in_size,
+                         w * dev->color_info.num_components);
+    /* A first guess at the band's compressed size; it grows if needed. */
+    uint size = w * h * dev->color_info.num_components / 8 + 4096;
+
+    buffer = (jpeg_band_buffer_t *)gs_alloc_bytes(mem, sizeof(jpeg_band_buffer_t) + fbuf_size + jbuf_size, "jpeg_band_init_buffer");
+    *pbuffer = (void *)buffer;
+    if (buffer == NULL)
+        return_error(gs_error_VMerror);
+    buffer->memory = mem;
+    buffer->fbuf = (byte *)(buffer + 1);
+    buffer->fbuf_size = fbuf_size;
+    buffer->jbuf = buffer->fbuf + fbuf_size;
+    buffer->jbuf_size = jbuf_size;
+    buffer->data = gs_alloc_bytes(mem, size, "jpeg_band_init_buffer(data)");
+    if (buffer->data == NULL) {
+        gs_free_object(mem, buffer, "jpeg_band_init_buffer");
+        *pbuffer = NULL;
+        return_error(gs_error_VMerror);
+    }
+    buffer->size = size;
+    buffer->len = 0;
+    return 0;
+}
+
+static void
+jpeg_band_free_buffer(void *arg, gx_device *dev, gs_memory_t *mem, void *buffer_)
+{
+    jpeg_band_buffer_t *buffer = (jpeg_band_buffer_t *)buffer_;
+
+    gs_free_object(mem, buffer->data, "jpeg_band_init_buffer(data)");
+    gs_free_object(mem, buffer, "jpeg_band_init_buffer");
+}
+
+/* Runs on a rendering thread: encode the band as a JPEG of its own. */
+static int
+jpeg_band_process(void *arg_, gx_device *dev, gx_device *bdev, const gs_int_rect *rect, void *buffer_)
+{
+    static const stream_procs p = {
+        s_std_noavailable, s_std_noseek, s_std_write_reset,
+        s_std_write_flush, s_std_null, jpeg_band_write_process
+    };
+    jpeg_band_arg_t *arg = (jpeg_band_arg_t *)arg_;
+    jpeg_band_buffer_t *buffer = (jpeg_band_buffer_t *)buffer_;
+    gs_memory_t *mem = buffer->memory;
+    int w = rect->q.x - rect->p.x;
+    int h = rect->q.y - rect->p.y;
+    uint raster = gx_device_raster(bdev, true);
+    gs_get_bits_params_t params;
+    gs_int_rect my_rect;
+    jpeg_compress_data *jcdp;
+    stream_DCT_state state;
+    stream jstrm;
+    const byte *row;
+    int code, i, h_samp = 1, v_samp = 1;
+
+    buffer->len = 0;
+    buffer->first = (rect->p.y == 0);
+    buffer->last = (rect->q.y >= arg->dev->height);
+    if (h <= 0 || w <= 0)
+        return 0;
+    /* Every band but the last must be a whole restart interval. */
+    if (h != arg->band_height && !buffer->last)
+        return_error(gs_error_rangecheck);
+
+    params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_CHUNKY | GB_RETURN_POINTER | GB_ALIGN_ANY | GB_OFFSET_0 | GB_RASTER_ANY;
+    my_rect.p.x = 0;
+    my_rect.p.y = 0;
+    my_rect.q.x = w;
+    my_rect.q.y = h;
+    code = dev_proc(bdev, get_bits_rectangle)(bdev, &my_rect, &params, NULL);
+    if (code < 0)
+        return code;
+
+    jcdp = gs_alloc_struct_immovable(mem, jpeg_compress_data,
+      &st_jpeg_compress_data, "jpeg_band_process(jpeg_compress_data)");
+    if (jcdp == 0)
+        return_error(gs_error_VMerror);
+    /* Only the first band's markers reach the file. */
+    code = jpeg_create_encoder(arg->dev, mem, jcdp, &state, w, h, buffer->first);
+    if (code < 0) {
+        gs_free_object(mem, jcdp, "jpeg_band_process(jpeg_compress_data)");
+        return code;
+    }
+    /* The MCU size the page was split on must be the one the IJG library uses. */
+    for (i = 0; i < jcdp->cinfo.num_components; i++) {
+        h_samp = max(h_samp, jcdp->cinfo.comp_info[i].h_samp_factor);
+        v_samp = max(v_samp, jcdp->cinfo.comp_info[i].v_samp_factor);
+    }
+    if (h_samp * DCTSIZE != arg->mcu_width || v_samp * DCTSIZE != arg->mcu_height) {
+        code = gs_note_error(gs_error_rangecheck);
+        goto done;
+    }
+
+    s_init(&buffer->fstrm, mem);
+    s_std_init(&buffer->fstrm, buffer->fbuf, buffer->fbuf_size, &p, s_mode_write);
+    s_init(&jstrm, mem);
+    s_std_init(&jstrm, buffer->jbuf, buffer->jbuf_size, &s_filter_write_procs,
+               s_mode_write);
+    jstrm.state = (stream_state *) & state;
+    jstrm.procs.process = state.templat->process;
+    jstrm.strm = &buffer->fstrm;
+    if (state.templat->init)
+        (*state.templat->init) (jstrm.state);
+
+    for (i = 0, row = params.data[0]; i < h; i++, row += raster) {
+        uint ignore_used;
+
+        if (jstrm.end_status) {
+            code = gs_note_error(gs_error_ioerror);
+            goto done;
+        }
+        sputs(&jstrm, row, state.scan_line_size, &ignore_used);
+    }
+    sclose(&jstrm);
+    sflush(&buffer->fstrm);
+    if (jstrm.end_status == ERRC || buffer->fstrm.end_status == ERRC)
+        code = gs_note_error(gs_error_ioerror);
+  done:
+    gs_jpeg_destroy(&state);
+    gs_free_object(mem, jcdp, "jpeg_band_process(jpeg_compress_data)");
+    return code;
+}
+
+/* Runs on the main thread, in band order. */
+static int
+jpeg_band_output(void *arg_, gx_device *dev, void *buffer_)
+{
+    jpeg_band_arg_t *arg = (jpeg_band_arg_t *)arg_;
+    jpeg_band_buffer_t *buffer = (jpeg_band_buffer_t *)buffer_;
+    byte *data = buffer->data;
+    uint len = buffer->len;
+    uint pos = 2, sof = 0, sos = 0, seg;
+
+    if (len == 0)
+        return 0;
+    /* Find the start of the scan data, noting where the frame header is. */
+    while (sos == 0) {
+        if (pos + 4 > len || data[pos] != 0xFF)
+            return_error(gs_error_ioerror);
+        seg = (data[pos + 2] << 8) + data[pos + 3];
+        if (data[pos + 1] == M_SOF0 || data[pos + 1] == M_SOF1)
+            sof = pos;
+        else if (data[pos + 1] == M_SOS)
+            sos = pos;
+        pos += 2 + seg;
+    }
+    if (sof == 0 || pos > len - 2)
+        return_error(gs_error_ioerror);
+    if (buffer->first) {
+        byte dri[6];
+
+        /* The frame header gets the page height. */
+        data[sof + 5] = (byte)(arg->dev->height >> 8);
+        data[sof + 6] = (byte)arg->dev->height;
+        dri[0] = 0xFF;
+        dri[1] = M_DRI;
+        dri[2] = 0;
+        dri[3] = 4;
+        dri[4] = (byte)(arg->restart_interval >> 8);
+        dri[5] = (byte)arg->restart_interval;
+        fwrite(data, 1, sos, arg->file);
+        fwrite(dri, 1, sizeof(dri), arg->file);
+        fwrite(data + sos, 1, pos - sos, arg->file);
+    } else {
+        byte rst[2];
+
+        rst[0] = 0xFF;
+        rst[1] = (byte)(JPEG_RST0 + ((arg->band - 1) & 7));
+        fwrite(rst, 1, sizeof(rst), arg->file);
+    }
+    /* The band's EOI ends the page after the last band. */
+    fwrite(data + pos, 1, len - pos - (buffer->last ? 0 : 2), arg->file);
+    buffer->len = 0;
+    arg->band++;
+    return (ferror(arg->file) ? gs_note_error(gs_error_ioerror) : 0);
+}
+
+/*
+ * Set up the band geometry, returning false if the page has to be
+ * encoded serially: bands must be whole MCU rows, and a band must fit
+ * in one restart interval.
+ */
+static bool
+jpeg_band_output_ok(gx_device_jpeg *jdev, jpeg_band_arg_t *arg)
+{
+    gx_device_printer *pdev = (gx_device_printer *)jdev;
+    int mcu_size = (pdev->color_info.depth == 24 ? 2 : 1) * DCTSIZE;
+    long interval;
+
+    if (!PRINTER_IS_CLIST(pdev) || pdev->num_render_threads_requested < 1 ||
+        jdev->downscale.downscale_factor > 1)
+        return false;
+    /* jpeg_set_defaults subsamples YCbCr chroma 2x2, and nothing else. */
+    arg->mcu_width = arg->mcu_height = mcu_size;
+    arg->band_height = ((gx_device_clist_common *)pdev)->page_info.band_params.BandHeight;
+    if (arg->band_height <= 0 || arg->band_height % mcu_size != 0 ||
+        arg->band_height >= pdev->height)
+        return false;
+    interval = (long)((pdev->width + mcu_size - 1) / mcu_size) *
+        (arg->band_height / mcu_size);
+    if (interval > 65535)
+        return false;
+    arg->restart_interval = (int)interval;
+    arg->band = 0;
+    return true;
+}
+
+static int
+jpeg_band_print_page(gx_device_jpeg *jdev, jpeg_band_arg_t *arg)
+{
+    gx_process_page_options_t process = { 0 };
+
+    process.init_buffer_fn = jpeg_band_init_buffer;
+    process.free_buffer_fn = jpeg_band_free_buffer;
+    process.process_fn = jpeg_band_process;
+    process.output_fn = jpeg_band_output;
+    process.arg = arg;
+
+    return dev_proc(jdev, process_page)((gx_device *)jdev, &process);
+}
+
+/* Send the page to the file. */
+static int
+jpeg_print_page(gx_device_printer * pdev, FILE * prn_stream)
+{
+    gx_device_jpeg *jdev = (gx_device_jpeg *) pdev;
+    gs_memory_t *mem = pdev->memory;
+    int line_size = gdev_mem_bytes_per_scan_line((gx_device *) pdev);
+    byte *in;
+    jpeg_compress_data *jcdp;
+    byte *fbuf = 0;
+    uint fbuf_size;
+    byte *jbuf = 0;
+    uint jbuf_size;
+    int lnum;
+    int code;
+    stream_DCT_state state;
+    stream fstrm, jstrm;
+    gx_downscaler_t ds;
+    jpeg_band_arg_t arg;
+
+    arg.dev = jdev;
+    arg.file = prn_stream;
+    if (jpeg_band_output_ok(jdev, &arg))
+        return jpeg_band_print_page(jdev, &arg);
+
+    in = gs_alloc_bytes(mem, line_size, "jpeg_print_page(in)");
+    jcdp = gs_alloc_struct_immovable(mem, jpeg_compress_data,
+      &st_jpeg_compress_data, "jpeg_print_page(jpeg_compress_data)");
+    if (jcdp == 0 || in == 0) {
+        code = gs_note_error(gs_error_VMerror);
+        goto fail;
+    }
+    code = gx_downscaler_init(&ds, (gx_device *)jdev, 8, 8,
+                              jdev->color_info.depth/8, jdev->downscale.downscale_factor, 0, NULL, 0);
+    if (code < 0) {
+        gs_free_object(mem, jcdp, "jpeg_print_page(jpeg_compress_data)");
+        jcdp = NULL;
+        goto fail;
+    }
+
+    code = jpeg_create_encoder(jdev, mem, jcdp, &state,
+                               gx_downscaler_scale(pdev->width, jdev->downscale.downscale_factor),
+                               gx_downscaler_scale(pdev->height, jdev->downscale.downscale_factor),
+                               true);
+    if (code < 0) {
+        gx_downscaler_fin(&ds);
+        goto fail;
+    }
 
     /* Set up the streams. */
     fbuf_size = max(512 /* arbitrary */ , jcdp->templat.min_out_size);
@@ -576,4 +895,3 @@ jpeg_print_page(gx_device_printer * pdev, FILE * prn_stream)
     gs_free_object(mem, in, "jpeg_print_page(in)");
     return code;
 }
-
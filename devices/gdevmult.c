@@ -0,0 +1,903 @@
+/* Copyright (C) 2001-2018 Artifex Software, Inc.
+   All Rights Reserved.
+
+   This software is provided AS-IS with no warranty, either express or
+   implied.
+
+   This software is distributed under license and may not be copied,
+   modified or distributed except as expressly authorized under the terms
+   of the license contained in the file LICENSE in this distribution.
+
+   Refer to licensing information at http://www.artifex.com or contact
+   Artifex Software, Inc.,  1305 Grant Avenue - Suite 200, Novato,
+   CA 94945, U.S.A., +1(415)492-9861, for further information.
+*/
+
+
+/* Devices that write each page at several resolutions in one pass */
+
+/*
+ * The multigray, multirgb and multicmyk devices interpret and render
+ * each page once, and hand it to any number of other raster devices,
+ * each with its own resolution, color model and file format.  The
+ * outputs are given as one string of entries separated by ';', each
+ * entry being a device name, a resolution and an output file:
+ *
+ *   gs -sDEVICE=multirgb -r300 -dNOPAUSE -dBATCH
+ *      -sOutputs="tiff24nc 300 print-%d.tif;jpeg 150 preview-%d.jpg;
+ *                 pnggray 72 thumb-%d.png" input.pdf
+ *
+ * Each output device takes its defaults for everything but
+ * HWResolution, PageSize and OutputFile.  It must store 8 bits per
+ * component, chunky, with 1, 3 or 4 components, and may not have a
+ * higher resolution than the multi device, which renders at its own
+ * resolution (-r) and writes nothing itself.
+ *
+ * Every output is thus an area-averaged downsample of the one master
+ * render, which allows any ratio of resolutions; an output at the
+ * master resolution gets the rendered rows unchanged, and so matches
+ * what that device would write on its own.  An output above the master
+ * resolution is rejected with a rangecheck when the page begins, since
+ * upsampling would only pretend to add detail.  Each band is reduced on the thread that
+ * rendered it (see -dNumRenderingThreads), and the finished output rows
+ * are converted from the multi device's ICC profile to the output's,
+ * if they differ, and copied to the output device in band order.
+ */
+
+#include "stdint_.h"
+#include "stdio_.h"
+#include "ctype_.h"
+#include "gdevprn.h"
+#include "gxgetbit.h"
+#include "gscms.h"
+#include "gsicc_cache.h"
+#include "gsicc_manage.h"
+
+/* ------ The device descriptors ------ */
+
+/*
+ * Default X and Y resolution.
+ */
+#define X_DPI 72
+#define Y_DPI 72
+
+/* An output device, and what it needs for the page being printed. */
+typedef struct mult_output_s {
+    const gx_device *proto;	/* prototype from the device list */
+    float resolution;
+    char fname[gp_file_name_sizeof];
+    gx_device *dev;		/* made at the first page */
+    gsicc_link_t *link;		/* from our colors to dev's, or NULL */
+    bool link_valid;
+    int64_t src_hash;		/* the profiles link was made for */
+    int64_t des_hash;
+    /* The rest is set up for each page. */
+    int width;			/* of dev */
+    int height;
+    int num_components;
+    int *xindex;		/* first output column of each of ours */
+    uint *xweight;		/* our column's shares of it and the next */
+    uint *pending;		/* sums for a row left over from a band */
+    int pending_row;		/* that row, or -1 */
+    int max_rows;		/* rows allocated in rows and conv */
+    byte *rows;			/* finished rows in our colors */
+    byte *conv;			/* and in dev's colors */
+} mult_output;
+
+typedef struct gx_device_mult_s {
+    gx_device_common;
+    gx_prn_device_common;
+    char Outputs[gp_file_name_sizeof];	/* as given */
+    int num_outputs;
+    mult_output *outputs;	/* parsed from Outputs at the first page */
+} gx_device_mult;
+
+static dev_proc_open_device(mult_open);
+static dev_proc_close_device(mult_close);
+static dev_proc_get_params(mult_get_params);
+static dev_proc_put_params(mult_put_params);
+static dev_proc_print_page_copies(mult_print_page_copies);
+
+#define mult_procs(map_rgb_color, map_color_rgb, map_cmyk_color)\
+{\
+        mult_open,\
+        NULL,	/* get_initial_matrix */\
+        NULL,	/* sync_output */\
+        gdev_prn_output_page,\
+        mult_close,\
+        map_rgb_color,\
+        map_color_rgb,\
+        NULL,	/* fill_rectangle */\
+        NULL,	/* tile_rectangle */\
+        NULL,	/* copy_mono */\
+        NULL,	/* copy_color */\
+        NULL,	/* draw_line */\
+        NULL,	/* get_bits */\
+        mult_get_params,\
+        mult_put_params,\
+        map_cmyk_color,\
+        NULL,	/* get_xfont_procs */\
+        NULL,	/* get_xfont_device */\
+        NULL,	/* map_rgb_alpha_color */\
+        gx_page_device_get_page_device\
+}
+
+/*
+ * The outputs are driven from this thread, so the page can't be printed
+ * in the background; and it is printed once for all copies.
+ */
+#define mult_device(procs, dname, ncomp, depth, mg, mc, dg, dc)\
+{       std_device_full_body_type(gx_device_mult, &procs, dname, &st_device_printer,\
+          (int)((float)(DEFAULT_WIDTH_10THS) * (X_DPI) / 10 + 0.5),\
+          (int)((float)(DEFAULT_HEIGHT_10THS) * (Y_DPI) / 10 + 0.5),\
+          X_DPI, Y_DPI,\
+          ncomp, depth, mg, mc, dg, dc,\
+          (float)(0), (float)(0),\
+          (float)(0), (float)(0),\
+          (float)(0), (float)(0)\
+        ),\
+        prn_device_body_copies_rest_(mult_print_page_copies),\
+        { 0 },		/* Outputs */\
+        0,		/* num_outputs */\
+        NULL		/* outputs */\
+}
+
+/* 8-bit gray. */
+
+static const gx_device_procs multgray_procs =
+    mult_procs(gx_default_gray_map_rgb_color, gx_default_gray_map_color_rgb,
+               NULL);
+const gx_device_mult gs_multigray_device =
+    mult_device(multgray_procs, "multigray", 1, 8, 255, 0, 256, 0);
+
+/* 24-bit color. */
+
+static const gx_device_procs multrgb_procs =
+    mult_procs(gx_default_rgb_map_rgb_color, gx_default_rgb_map_color_rgb,
+               NULL);
+const gx_device_mult gs_multirgb_device =
+    mult_device(multrgb_procs, "multirgb", 3, 24, 255, 255, 256, 256);
+
+/* 32-bit CMYK. */
+
+static const gx_device_procs multcmyk_procs =
+    mult_procs(NULL, cmyk_8bit_map_color_rgb, cmyk_8bit_map_cmyk_color);
+const gx_device_mult gs_multicmyk_device =
+    mult_device(multcmyk_procs, "multicmyk", 4, 32, 255, 255, 256, 256);
+
+/* ------ Parameters ------ */
+
+/*
+ * Parse an Outputs string, filling in outputs if it isn't NULL.
+ * Return the number of outputs.
+ */
+static int
+mult_parse_outputs(gx_device *dev, const char *spec, mult_output *outputs)
+{
+    const char *p = spec;
+    int count = 0;
+
+    while (*p) {
+        const char *end = strchr(p, ';');
+        const char *name, *fname;
+        const gx_device *proto;
+        uint name_len, fname_len;
+        float resolution;
+        int i, n;
+
+        if (end == NULL)
+            end = p + strlen(p);
+        while (p < end && isspace((unsigned char)*p))
+            p++;
+        if (p == end) {		/* empty entry */
+            p = (*end ? end + 1 : end);
+            continue;
+        }
+
+        name = p;
+        while (p < end && !isspace((unsigned char)*p))
+            p++;
+        name_len = p - name;
+        for (i = 0; (proto = gs_getdevice(i)) != NULL; i++)
+            if (strlen(proto->dname) == name_len &&
+                !memcmp(proto->dname, name, name_len))
+                break;
+        if (proto == NULL ||
+            proto == (const gx_device *)&gs_multigray_device ||
+            proto == (const gx_device *)&gs_multirgb_device ||
+            proto == (const gx_device *)&gs_multicmyk_device)
+            goto bad;
+
+        if (sscanf(p, "%f%n", &resolution, &n) != 1 || p + n > end ||
+            !(resolution > 0))
+            goto bad;
+        p += n;
+
+        while (p < end && isspace((unsigned char)*p))
+            p++;
+        fname = p;
+        fname_len = end - fname;
+        while (fname_len > 0 && isspace((unsigned char)fname[fname_len - 1]))
+            fname_len--;
+        if (fname_len == 0 || fname_len >= gp_file_name_sizeof)
+            goto bad;
+
+        if (outputs != NULL) {
+            mult_output *o = &outputs[count];
+
+            memset(o, 0, sizeof(*o));
+            o->proto = proto;
+            o->resolution = resolution;
+            memcpy(o->fname, fname, fname_len);
+            o->fname[fname_len] = 0;
+            o->pending_row = -1;
+        }
+        count++;
+        p = (*end ? end + 1 : end);
+        continue;
+
+bad:
+        emprintf3(dev->memory,
+                  "Device '%s' can't use output '%.*s'.\n",
+                  dev->dname, (int)(end - name), name);
+        return_error(gs_error_rangecheck);
+    }
+    return count;
+}
+
+static void mult_release_outputs(gx_device_mult *mdev);
+
+static int
+mult_get_params(gx_device *dev, gs_param_list *plist)
+{
+    gx_device_mult *mdev = (gx_device_mult *)dev;
+    gs_param_string outputs;
+    int code, ecode;
+
+    ecode = 0;
+    param_string_from_transient_string(outputs, mdev->Outputs);
+    if ((code = param_write_string(plist, "Outputs", &outputs)) < 0)
+        ecode = code;
+
+    code = gdev_prn_get_params(dev, plist);
+    if (code < 0)
+        ecode = code;
+
+    return ecode;
+}
+
+static int
+mult_put_params(gx_device *dev, gs_param_list *plist)
+{
+    gx_device_mult *mdev = (gx_device_mult *)dev;
+    char spec[gp_file_name_sizeof];
+    gs_param_string outputs;
+    bool set_outputs = false;
+    int code, ecode = 0;
+
+    switch (code = param_read_string(plist, "Outputs", &outputs)) {
+        case 0:
+            if (outputs.size >= sizeof(spec))
+                code = gs_error_limitcheck;
+            else {
+                memcpy(spec, outputs.data, outputs.size);
+                spec[outputs.size] = 0;
+                code = mult_parse_outputs(dev, spec, NULL);
+                if (code >= 0) {
+                    set_outputs = strcmp(spec, mdev->Outputs) != 0;
+                    break;
+                }
+            }
+        default:
+            param_signal_error(plist, "Outputs", code);
+            ecode = code;
+        case 1:
+            break;
+    }
+
+    code = gdev_prn_put_params(dev, plist);
+    if (code < 0)
+        ecode = code;
+    if (ecode < 0)
+        return ecode;
+
+    if (set_outputs) {
+        /* The new outputs are made at the next page. */
+        mult_release_outputs(mdev);
+        strcpy(mdev->Outputs, spec);
+    }
+    return 0;
+}
+
+/* ------ Output devices ------ */
+
+/* Free what mult_begin_page allocated. */
+static void
+mult_end_page(gx_device_mult *mdev, mult_output *o)
+{
+    gs_memory_t *mem = mdev->memory->non_gc_memory;
+
+    gs_free_object(mem, o->xindex, "mult_end_page(xindex)");
+    gs_free_object(mem, o->xweight, "mult_end_page(xweight)");
+    gs_free_object(mem, o->pending, "mult_end_page(pending)");
+    gs_free_object(mem, o->rows, "mult_end_page(rows)");
+    gs_free_object(mem, o->conv, "mult_end_page(conv)");
+    o->xindex = NULL;
+    o->xweight = NULL;
+    o->pending = NULL;
+    o->pending_row = -1;
+    o->rows = o->conv = NULL;
+    o->max_rows = 0;
+}
+
+static void
+mult_free_link(gx_device_mult *mdev, mult_output *o)
+{
+    if (o->link != NULL) {
+        o->link->procs.free_link(o->link);
+        gsicc_free_link_dev(mdev->memory, o->link);
+        o->link = NULL;
+    }
+    o->link_valid = false;
+}
+
+/* Close and free the output devices; they are made again when needed. */
+static void
+mult_release_outputs(gx_device_mult *mdev)
+{
+    int i;
+
+    for (i = 0; i < mdev->num_outputs; i++) {
+        mult_output *o = &mdev->outputs[i];
+
+        mult_end_page(mdev, o);
+        mult_free_link(mdev, o);
+        if (o->dev != NULL) {
+            gs_closedevice(o->dev);
+            gx_device_retain(o->dev, false);
+            o->dev = NULL;
+        }
+    }
+    gs_free_object(mdev->memory->non_gc_memory, mdev->outputs,
+                   "mult_release_outputs");
+    mdev->outputs = NULL;
+    mdev->num_outputs = 0;
+}
+
+/* Give the output our page size, its resolution and its file. */
+static int
+mult_put_output_params(gx_device_mult *mdev, mult_output *o)
+{
+    gs_c_param_list list;
+    gs_param_string fname;
+    gs_param_float_array fa;
+    float resolution[2], size[2];
+    int code;
+
+    resolution[0] = resolution[1] = o->resolution;
+    size[0] = mdev->MediaSize[0];
+    size[1] = mdev->MediaSize[1];
+    fa.size = 2;
+    fa.persistent = false;
+
+    gs_c_param_list_write(&list, mdev->memory);
+    param_string_from_transient_string(fname, o->fname);
+    code = param_write_string((gs_param_list *)&list, "OutputFile", &fname);
+    if (code >= 0) {
+        fa.data = resolution;
+        code = param_write_float_array((gs_param_list *)&list,
+                                       "HWResolution", &fa);
+    }
+    if (code >= 0) {
+        fa.data = size;
+        code = param_write_float_array((gs_param_list *)&list,
+                                       "PageSize", &fa);
+    }
+    if (code >= 0) {
+        gs_c_param_list_read(&list);
+        code = gs_putdeviceparams(o->dev, (gs_param_list *)&list);
+    }
+    gs_c_param_list_release(&list);
+    return code;
+}
+
+/* Make the link from our colors to the output's, unless they are the same. */
+static int
+mult_check_link(gx_device_mult *mdev, mult_output *o)
+{
+    cmm_dev_profile_t *src_struct, *des_struct;
+    cmm_profile_t *src, *des;
+    gsicc_rendering_param_t rendering_params;
+    int code;
+
+    code = dev_proc(mdev, get_profile)((gx_device *)mdev, &src_struct);
+    if (code < 0)
+        return code;
+    code = dev_proc(o->dev, get_profile)(o->dev, &des_struct);
+    if (code < 0)
+        return code;
+    if (src_struct == NULL || des_struct == NULL)
+        return_error(gs_error_undefined);
+    src = src_struct->device_profile[0];
+    des = des_struct->device_profile[0];
+    if (src == NULL || des == NULL)
+        return_error(gs_error_undefined);
+
+    if (o->link_valid && gsicc_get_hash(src) == o->src_hash &&
+        gsicc_get_hash(des) == o->des_hash)
+        return 0;
+
+    mult_free_link(mdev, o);
+    o->src_hash = gsicc_get_hash(src);
+    o->des_hash = gsicc_get_hash(des);
+    if (o->src_hash != o->des_hash) {
+        rendering_params.black_point_comp = gsBLACKPTCOMP_ON;
+        rendering_params.graphics_type_tag = GS_UNKNOWN_TAG;
+        rendering_params.override_icc = false;
+        rendering_params.preserve_black = gsBLACKPRESERVE_OFF;
+        rendering_params.rendering_intent = gsRELATIVECOLORIMETRIC;
+        rendering_params.cmm = gsCMM_DEFAULT;
+        o->link = gsicc_alloc_link_dev(mdev->memory, src, des,
+                                       &rendering_params);
+        if (o->link == NULL)
+            return_error(gs_error_VMerror);
+    }
+    o->link_valid = true;
+    return 0;
+}
+
+/*
+ * Our row or column n covers [n * out_size, (n + 1) * out_size) in units
+ * where output row or column i covers [i * size, (i + 1) * size).  Since
+ * out_size <= size, it overlaps at most two of them, i and i + 1.
+ * Return i, and set weights to our shares of them, as 16.16 fractions
+ * that add up to exactly 1 for each output pixel, so that the sums of
+ * a flat area come out flat, and the sums for an integer ratio exact.
+ */
+#define MULT_ONE 0x10000
+
+static uint
+mult_share(int64_t t, int64_t start, int size)
+{
+    return (uint)(((t - start) * MULT_ONE + size / 2) / size);
+}
+
+static int
+mult_weights(int n, int out_size, int size, uint weights[2])
+{
+    int64_t left = (int64_t)n * out_size;
+    int64_t right = left + out_size;
+    int i = (int)(left / size);
+    int64_t start = (int64_t)i * size;
+    int64_t edge = start + size;
+
+    if (right <= edge) {
+        weights[0] = mult_share(right, start, size) - mult_share(left, start, size);
+        weights[1] = 0;
+    } else {
+        weights[0] = MULT_ONE - mult_share(left, start, size);
+        weights[1] = mult_share(right, edge, size);
+    }
+    return i;
+}
+
+/* Get an output device ready for the page. */
+static int
+mult_begin_page(gx_device_mult *mdev, mult_output *o)
+{
+    gx_device *dev = (gx_device *)mdev;
+    gs_memory_t *mem = dev->memory->non_gc_memory;
+    int num_comps = dev->color_info.num_components;
+    int x, code;
+
+    if (o->dev == NULL) {
+        cmm_dev_profile_t *profile_struct;
+
+        code = gs_copydevice(&o->dev, o->proto, mem);
+        if (code < 0)
+            return code;
+        /* As gs_setdevice_no_erase does, before the device is opened. */
+        gx_device_fill_in_procs(o->dev);
+        code = dev_proc(o->dev, get_profile)(o->dev, &profile_struct);
+        if (code >= 0 && (profile_struct == NULL ||
+                          profile_struct->device_profile[0] == NULL))
+            code = gsicc_init_device_profile_struct(o->dev, NULL,
+                                                    gsDEFAULTPROFILE);
+        if (code < 0)
+            return code;
+    }
+    code = mult_put_output_params(mdev, o);
+    if (code < 0)
+        return code;
+    code = gs_opendevice(o->dev);
+    if (code < 0)
+        return code;
+
+    o->width = o->dev->width;
+    o->height = o->dev->height;
+    o->num_components = o->dev->color_info.num_components;
+    if ((o->num_components != 1 && o->num_components != 3 &&
+         o->num_components != 4) ||
+        o->dev->color_info.depth != 8 * o->num_components) {
+        emprintf2(dev->memory,
+                  "Device '%s' needs 8 bits per component from '%s'.\n",
+                  dev->dname, o->dev->dname);
+        return_error(gs_error_rangecheck);
+    }
+    if (o->width > dev->width || o->height > dev->height ||
+        o->width <= 0 || o->height <= 0) {
+        emprintf2(dev->memory,
+                  "Device '%s' can't render '%s' at a higher resolution than its own.\n",
+                  dev->dname, o->dev->dname);
+        return_error(gs_error_rangecheck);
+    }
+
+    code = mult_check_link(mdev, o);
+    if (code < 0)
+        return code;
+    if ((o->link == NULL && o->num_components != num_comps) ||
+        (o->link != NULL && (o->link->num_input != num_comps ||
+                             o->link->num_output != o->num_components)))
+        return_error(gs_error_rangecheck);
+
+    o->xindex = (int *)gs_alloc_byte_array(mem, dev->width, sizeof(int),
+                                           "mult_begin_page(xindex)");
+    o->xweight = (uint *)gs_alloc_byte_array(mem, dev->width * 2, sizeof(uint),
+                                             "mult_begin_page(xweight)");
+    o->pending = (uint *)gs_alloc_byte_array(mem, o->width * num_comps,
+                                             sizeof(uint),
+                                             "mult_begin_page(pending)");
+    if (o->xindex == NULL || o->xweight == NULL || o->pending == NULL)
+        return_error(gs_error_VMerror);
+    for (x = 0; x < dev->width; x++)
+        o->xindex[x] = mult_weights(x, o->width, dev->width, &o->xweight[x * 2]);
+    o->pending_row = -1;
+    return 0;
+}
+
+/* ------ Rendering ------ */
+
+/* A band's partial sums for one output. */
+typedef struct mult_band_s {
+    int first_row;		/* output row of acc[0] */
+    int num_rows;
+    int max_rows;		/* rows allocated in acc */
+    uint *hrow;			/* one of our rows reduced across, 8.8 */
+    uint *acc;			/* num_rows output rows, 8.24 */
+} mult_band;
+
+/* A rendering thread's buffer. */
+typedef struct mult_buffer_s {
+    int y;			/* our rows y to y + height - 1 */
+    int height;
+    mult_band *bands;		/* one per output */
+} mult_buffer;
+
+static void
+mult_free_buffer(void *arg, gx_device *dev, gs_memory_t *mem, void *buffer_)
+{
+    gx_device_mult *mdev = (gx_device_mult *)arg;
+    mult_buffer *buffer = (mult_buffer *)buffer_;
+    int i;
+
+    if (buffer == NULL)
+        return;
+    if (buffer->bands != NULL) {
+        for (i = 0; i < mdev->num_outputs; i++) {
+            gs_free_object(mem, buffer->bands[i].hrow, "mult_init_buffer(hrow)");
+            gs_free_object(mem, buffer->bands[i].acc, "mult_init_buffer(acc)");
+        }
+        gs_free_object(mem, buffer->bands, "mult_init_buffer(bands)");
+    }
+    gs_free_object(mem, buffer, "mult_init_buffer");
+}
+
+static int
+mult_init_buffer(void *arg, gx_device *dev, gs_memory_t *mem, int w, int h, void **pbuffer)
+{
+    gx_device_mult *mdev = (gx_device_mult *)arg;
+    int num_comps = mdev->color_info.num_components;
+    mult_buffer *buffer;
+    int i;
+
+    buffer = (mult_buffer *)gs_alloc_bytes(mem, sizeof(mult_buffer), "mult_init_buffer");
+    *pbuffer = (void *)buffer;
+    if (buffer == NULL)
+        return_error(gs_error_VMerror);
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->bands = (mult_band *)gs_alloc_byte_array(mem, mdev->num_outputs,
+                                sizeof(mult_band), "mult_init_buffer(bands)");
+    if (buffer->bands == NULL)
+        return_error(gs_error_VMerror);
+    memset(buffer->bands, 0, mdev->num_outputs * sizeof(mult_band));
+    for (i = 0; i < mdev->num_outputs; i++) {
+        mult_output *o = &mdev->outputs[i];
+        mult_band *b = &buffer->bands[i];
+        int span = o->width * num_comps;
+
+        /* h of our rows touch at most this many output rows. */
+        b->max_rows = (int)((int64_t)h * o->height / mdev->height) + 2;
+        b->hrow = (uint *)gs_alloc_byte_array(mem, span, sizeof(uint),
+                                              "mult_init_buffer(hrow)");
+        b->acc = (uint *)gs_alloc_byte_array(mem, b->max_rows * span,
+                                sizeof(uint), "mult_init_buffer(acc)");
+        if (b->hrow == NULL || b->acc == NULL)
+            return_error(gs_error_VMerror);
+    }
+    return 0;
+}
+
+/*
+ * Reduce one of our rows across to an output's width, as 8.8 fixed
+ * point, so that the rows for an output row can be summed in a uint.
+ */
+static void
+mult_reduce_row(const mult_output *o, int num_comps, int width,
+                const byte *in, uint *out)
+{
+    int span = o->width * num_comps;
+    int x, k;
+
+    if (o->width == width) {
+        for (k = 0; k < span; k++)
+            out[k] = in[k] << 8;
+        return;
+    }
+    memset(out, 0, span * sizeof(*out));
+    for (x = 0; x < width; x++, in += num_comps) {
+        uint *q = out + o->xindex[x] * num_comps;
+        uint a = o->xweight[x * 2];
+        uint b = o->xweight[x * 2 + 1];
+
+        if (b == 0) {
+            for (k = 0; k < num_comps; k++)
+                q[k] += in[k] * a;
+        } else {
+            for (k = 0; k < num_comps; k++) {
+                q[k] += in[k] * a;
+                q[num_comps + k] += in[k] * b;
+            }
+        }
+    }
+    for (k = 0; k < span; k++)
+        out[k] = (out[k] + 0x80) >> 8;
+}
+
+/*
+ * Runs on the rendering thread.  Sums the band into the rows of each
+ * output that it touches; output rows at either edge of the band are
+ * finished off by mult_output_band.
+ */
+static int
+mult_process(void *arg, gx_device *dev, gx_device *bdev, const gs_int_rect *rect, void *buffer_)
+{
+    gx_device_mult *mdev = (gx_device_mult *)arg;
+    mult_buffer *buffer = (mult_buffer *)buffer_;
+    int num_comps = mdev->color_info.num_components;
+    gs_get_bits_params_t params;
+    gs_int_rect my_rect;
+    uint raster;
+    int i, y, k, code;
+
+    my_rect.p.x = 0;
+    my_rect.p.y = 0;
+    my_rect.q.x = rect->q.x - rect->p.x;
+    my_rect.q.y = rect->q.y - rect->p.y;
+    params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_CHUNKY |
+                     GB_RETURN_POINTER | GB_ALIGN_ANY | GB_OFFSET_0 | GB_RASTER_ANY;
+    code = dev_proc(bdev, get_bits_rectangle)(bdev, &my_rect, &params, NULL);
+    if (code < 0)
+        return code;
+    raster = gx_device_raster(bdev, true);
+    buffer->y = rect->p.y;
+    buffer->height = my_rect.q.y;
+
+    for (i = 0; i < mdev->num_outputs; i++) {
+        const mult_output *o = &mdev->outputs[i];
+        mult_band *b = &buffer->bands[i];
+        int span = o->width * num_comps;
+
+        b->first_row = (int)((int64_t)rect->p.y * o->height / mdev->height);
+        b->num_rows = (int)(((int64_t)rect->q.y * o->height - 1) / mdev->height) -
+                      b->first_row + 1;
+        if (b->num_rows > b->max_rows)
+            return_error(gs_error_unregistered); /* Must not happen. */
+        if (o->width == mdev->width && o->height == mdev->height) {
+            /* Nothing to reduce: keep the rows as they are. */
+            for (y = 0; y < b->num_rows; y++)
+                memcpy((byte *)b->acc + y * span,
+                       params.data[0] + y * raster, span);
+            continue;
+        }
+        memset(b->acc, 0, b->num_rows * span * sizeof(uint));
+
+        for (y = rect->p.y; y < rect->q.y; y++) {
+            uint w[2];
+            int j = mult_weights(y, o->height, mdev->height, w);
+            uint *acc = b->acc + (j - b->first_row) * span;
+
+            mult_reduce_row(o, num_comps, mdev->width,
+                            params.data[0] + (y - rect->p.y) * raster,
+                            b->hrow);
+            for (k = 0; k < span; k++)
+                acc[k] += b->hrow[k] * w[0];
+            if (w[1] != 0) {
+                acc += span;
+                for (k = 0; k < span; k++)
+                    acc[k] += b->hrow[k] * w[1];
+            }
+        }
+    }
+    return 0;
+}
+
+/* Convert finished rows to the output's colors and copy them to it. */
+static int
+mult_write_rows(gx_device_mult *mdev, mult_output *o, const byte *data,
+                int y, int count)
+{
+    int num_comps = mdev->color_info.num_components;
+    int raster = o->width * num_comps;
+
+    if (o->link != NULL) {
+        gsicc_bufferdesc_t input_desc, output_desc;
+
+        gsicc_init_buffer(&input_desc, (unsigned char)num_comps, 1, false,
+                          false, false, 0, raster, count, o->width);
+        raster = o->width * o->num_components;
+        gsicc_init_buffer(&output_desc, (unsigned char)o->num_components, 1,
+                          false, false, false, 0, raster, count, o->width);
+        o->link->procs.map_buffer(NULL, o->link, &input_desc, &output_desc,
+                                  (byte *)data, o->conv);
+        data = o->conv;
+    }
+    return dev_proc(o->dev, copy_color)(o->dev, data, 0, raster,
+                                        gx_no_bitmap_id, 0, y,
+                                        o->width, count);
+}
+
+/* Runs on the main thread, in band order. */
+static int
+mult_output_band(void *arg, gx_device *dev, void *buffer_)
+{
+    gx_device_mult *mdev = (gx_device_mult *)arg;
+    mult_buffer *buffer = (mult_buffer *)buffer_;
+    gs_memory_t *mem = mdev->memory->non_gc_memory;
+    int num_comps = mdev->color_info.num_components;
+    int i, r, k, code;
+
+    for (i = 0; i < mdev->num_outputs; i++) {
+        mult_output *o = &mdev->outputs[i];
+        mult_band *b = &buffer->bands[i];
+        int span = o->width * num_comps;
+        int64_t end = (int64_t)(buffer->y + buffer->height) * o->height;
+        int done = 0;
+
+        if (b->num_rows > o->max_rows) {
+            gs_free_object(mem, o->rows, "mult_output_band(rows)");
+            gs_free_object(mem, o->conv, "mult_output_band(conv)");
+            o->max_rows = 0;
+            o->rows = gs_alloc_byte_array(mem, b->num_rows, span,
+                                          "mult_output_band(rows)");
+            o->conv = gs_alloc_byte_array(mem, b->num_rows,
+                                          o->width * o->num_components,
+                                          "mult_output_band(conv)");
+            if (o->rows == NULL || o->conv == NULL)
+                return_error(gs_error_VMerror);
+            o->max_rows = b->num_rows;
+        }
+
+        if (o->width == mdev->width && o->height == mdev->height) {
+            code = mult_write_rows(mdev, o, (const byte *)b->acc,
+                                   b->first_row, b->num_rows);
+            if (code < 0)
+                return code;
+            continue;
+        }
+
+        for (r = 0; r < b->num_rows; r++) {
+            uint *acc = b->acc + r * span;
+            int j = b->first_row + r;
+            byte *row;
+
+            if (j == o->pending_row) {
+                for (k = 0; k < span; k++)
+                    acc[k] += o->pending[k];
+                o->pending_row = -1;
+            }
+            if ((int64_t)(j + 1) * mdev->height > end) {
+                /* The rest of this row is in the next band. */
+                memcpy(o->pending, acc, span * sizeof(uint));
+                o->pending_row = j;
+                break;
+            }
+            row = o->rows + done * span;
+            for (k = 0; k < span; k++)
+                row[k] = (byte)((acc[k] + 0x800000) >> 24);
+            done++;
+        }
+        if (done > 0) {
+            code = mult_write_rows(mdev, o, o->rows, b->first_row, done);
+            if (code < 0)
+                return code;
+        }
+    }
+    return 0;
+}
+
+/* Render the page once, and output it on each device. */
+static int
+mult_print_page_copies(gx_device_printer *pdev, FILE *file, int num_copies)
+{
+    gx_device_mult *mdev = (gx_device_mult *)pdev;
+    gx_process_page_options_t process = { 0 };
+    int i, count, code = 0, ecode;
+
+    if (mdev->outputs == NULL) {
+        count = mult_parse_outputs((gx_device *)pdev, mdev->Outputs, NULL);
+        if (count < 0)
+            return count;
+        if (count == 0) {
+            emprintf1(pdev->memory, "Device '%s' requires -sOutputs.\n",
+                      pdev->dname);
+            return_error(gs_error_undefined);
+        }
+        mdev->outputs = (mult_output *)gs_alloc_byte_array(pdev->memory->non_gc_memory,
+                                count, sizeof(mult_output), "mult_print_page");
+        if (mdev->outputs == NULL)
+            return_error(gs_error_VMerror);
+        mult_parse_outputs((gx_device *)pdev, mdev->Outputs, mdev->outputs);
+        mdev->num_outputs = count;
+    }
+
+    for (i = 0; i < mdev->num_outputs && code >= 0; i++)
+        code = mult_begin_page(mdev, &mdev->outputs[i]);
+
+    if (code >= 0) {
+        process.init_buffer_fn = mult_init_buffer;
+        process.free_buffer_fn = mult_free_buffer;
+        process.process_fn = mult_process;
+        process.output_fn = mult_output_band;
+        /* The rendering threads get copies of the device without the
+         * outputs, so hand ourselves to them. */
+        process.arg = mdev;
+        code = dev_proc(pdev, process_page)((gx_device *)pdev, &process);
+    }
+
+    for (i = 0; i < mdev->num_outputs; i++) {
+        mult_output *o = &mdev->outputs[i];
+
+        if (code >= 0) {
+            ecode = dev_proc(o->dev, output_page)(o->dev, num_copies, true);
+            if (ecode < 0)
+                code = ecode;
+        }
+        mult_end_page(mdev, o);
+    }
+    return code;
+}
+
+/* ------ Open and close ------ */
+
+/*
+ * Nothing is ever written to the output file, so don't insist on one.
+ * Always band: each band is reduced as it is rendered, and a page buffer
+ * would need sums for every output row at once.
+ */
+static int
+mult_open(gx_device *pdev)
+{
+    gx_device_printer *ppdev = (gx_device_printer *)pdev;
+
+    if (ppdev->fname[0] == 0)
+        strcpy(ppdev->fname, "-");
+    ppdev->space_params.banding_type = BandingAlways;
+    return gdev_prn_open(pdev);
+}
+
+static int
+mult_close(gx_device *pdev)
+{
+    mult_release_outputs((gx_device_mult *)pdev);
+    return gdev_prn_close(pdev);
+}
@@ -49,11 +49,13 @@
  */
 /*#define PNG_NO_STDIO*/
 #include "png_.h"
+#include "zlib.h"
 
 #include "gdevprn.h"
 #include "gdevmem.h"
 #include "gdevpccm.h"
 #include "gscdefs.h"
+#include "gxgetbit.h"
 #include "gxdownscale.h"
 
 /* ------ The device descriptors ------ */
@@ -414,6 +416,305 @@ gdevpng_free(png_structp png, png_voidp ptr)
 }
 
 
+/*
+ * Band parallel output. When a clist page is rendered with rendering
+ * threads, the rows of each band are filtered and deflated on the thread
+ * that rendered it, and the main thread writes each band out as an IDAT
+ * chunk, in band order. The bands are deflated independently as raw
+ * streams, each ending on a sync flush except the last, so together they
+ * make one zlib stream once the main thread adds the header and the
+ * combined Adler-32. The first row of a band has no row above it here,
+ * so only the None and Sub filters are tried for it. Palette, 1 bit,
+ * 16 bit and downscaled output stay with libpng.
+ */
+typedef struct png_band_arg_s {
+    FILE *file;
+    int height;
+    int bpp;                    /* bytes per pixel */
+    bool invert_alpha;
+    uLong adler;                /* of the data output so far */
+} png_band_arg_t;
+
+typedef struct png_band_buffer_s {
+    gs_memory_t *memory;
+    byte *rows[2];              /* best and trial filtered row */
+    byte *data;                 /* the deflated band */
+    uint size;
+    uint compressed;
+    uLong adler;
+    uLong length;
+    bool last;
+} png_band_buffer_t;
+
+static voidpf
+png_band_zalloc(voidpf mem_, uInt items, uInt size)
+{
+    gs_memory_t *mem = (gs_memory_t *)mem_;
+
+    return gs_alloc_bytes(mem, items * size, "png_band_zalloc");
+}
+
+static void
+png_band_zfree(voidpf mem_, voidpf address)
+{
+    gs_memory_t *mem = (gs_memory_t *)mem_;
+
+    gs_free_object(mem, address, "png_band_zalloc");
+}
+
+static void
+png_band_put32(byte *p, uLong v)
+{
+    p[0] = (byte)(v >> 24);
+    p[1] = (byte)(v >> 16);
+    p[2] = (byte)(v >> 8);
+    p[3] = (byte)v;
+}
+
+static int
+png_band_put_chunk(const char *tag, const byte *data, uint size, FILE *file)
+{
+    byte buf[4];
+    uLong sum;
+
+    png_band_put32(buf, size);
+    if (fwrite(buf, 1, 4, file) != 4 || fwrite(tag, 1, 4, file) != 4)
+        return_error(gs_error_ioerror);
+    if (size && fwrite(data, 1, size, file) != size)
+        return_error(gs_error_ioerror);
+    sum = crc32(0, NULL, 0);
+    sum = crc32(sum, (const byte *)tag, 4);
+    if (size)
+        sum = crc32(sum, data, size);
+    png_band_put32(buf, sum);
+    if (fwrite(buf, 1, 4, file) != 4)
+        return_error(gs_error_ioerror);
+    return 0;
+}
+
+static int
+png_band_init_buffer(void *arg_, gx_device *dev, gs_memory_t *mem, int w, int h, void **pbuffer)
+{
+    png_band_arg_t *arg = (png_band_arg_t *)arg_;
+    png_band_buffer_t *buffer;
+    uint row_size = w * arg->bpp + 1;
+    /* Room for the zlib header and trailer, and the final flush. */
+    uint size = compressBound((uLong)row_size * h) + 16;
+
+    buffer = (png_band_buffer_t *)gs_alloc_bytes(mem, sizeof(png_band_buffer_t) + 2 * row_size + size, "png_band_init_buffer");
+    *pbuffer = (void *)buffer;
+    if (buffer == NULL)
+        return_error(gs_error_VMerror);
+    buffer->memory = mem;
+    buffer->rows[0] = (byte *)(buffer + 1);
+    buffer->rows[1] = buffer->rows[0] + row_size;
+    buffer->data = buffer->rows[1] + row_size;
+    buffer->size = size;
+    buffer->compressed = 0;
+    buffer->last = false;
+    return 0;
+}
+
+static void
+png_band_free_buffer(void *arg, gx_device *dev, gs_memory_t *mem, void *buffer)
+{
+    gs_free_object(mem, buffer, "png_band_init_buffer");
+}
+
+/* Apply filter type to row, into out[1..n]. Returns the sum of the
+ * filtered bytes taken as signed, which libpng also uses to choose. */
+static uint
+png_band_filter_row(byte *out, int type, const byte *row, const byte *prev, int n, int bpp)
+{
+    byte *o = out + 1;
+    uint sum = 0;
+    int i;
+
+    out[0] = (byte)type;
+    switch (type) {
+        case 0:
+            memcpy(o, row, n);
+            break;
+        case 1:
+            for (i = 0; i < bpp; i++)
+                o[i] = row[i];
+            for (; i < n; i++)
+                o[i] = row[i] - row[i - bpp];
+            break;
+        case 2:
+            for (i = 0; i < n; i++)
+                o[i] = row[i] - prev[i];
+            break;
+        case 3:
+            for (i = 0; i < bpp; i++)
+                o[i] = row[i] - (prev[i] >> 1);
+            for (; i < n; i++)
+                o[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+            break;
+        case 4:
+            for (i = 0; i < bpp; i++)
+                o[i] = row[i] - prev[i];
+            for (; i < n; i++) {
+                int a = row[i - bpp], b = prev[i], c = prev[i - bpp];
+                int pa = b - c, pb = a - c, pc = pa + pb;
+
+                if (pa < 0) pa = -pa;
+                if (pb < 0) pb = -pb;
+                if (pc < 0) pc = -pc;
+                o[i] = row[i] - (pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+            }
+            break;
+    }
+    for (i = 0; i < n; i++)
+        sum += (o[i] < 128 ? o[i] : 256 - o[i]);
+    return sum;
+}
+
+/* Runs on the rendering thread: filter and deflate the band. */
+static int
+png_band_process(void *arg_, gx_device *dev, gx_device *bdev, const gs_int_rect *rect, void *buffer_)
+{
+    png_band_arg_t *arg = (png_band_arg_t *)arg_;
+    png_band_buffer_t *buffer = (png_band_buffer_t *)buffer_;
+    int w = rect->q.x - rect->p.x;
+    int h = rect->q.y - rect->p.y;
+    int bpp = arg->bpp;
+    int n = w * bpp;
+    uint raster = gx_device_raster(bdev, true);
+    gs_get_bits_params_t params;
+    gs_int_rect my_rect;
+    z_stream stream;
+    byte *data, *row, *out;
+    int code, err, x, y, type;
+
+    buffer->compressed = 0;
+    buffer->last = (rect->q.y >= arg->height);
+    if (h <= 0 || w <= 0)
+        return 0;
+
+    params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_CHUNKY | GB_RETURN_POINTER | GB_ALIGN_ANY | GB_OFFSET_0 | GB_RASTER_ANY;
+    my_rect.p.x = 0;
+    my_rect.p.y = 0;
+    my_rect.q.x = w;
+    my_rect.q.y = h;
+    code = dev_proc(bdev, get_bits_rectangle)(bdev, &my_rect, &params, NULL);
+    if (code < 0)
+        return code;
+    data = params.data[0];
+
+    /* pngalpha stores alpha inverted, as libpng is told on the serial path. */
+    if (arg->invert_alpha) {
+        for (y = 0, row = data; y < h; y++, row += raster)
+            for (x = 3; x < n; x += 4)
+                row[x] ^= 0xff;
+    }
+
+    stream.zalloc = png_band_zalloc;
+    stream.zfree = png_band_zfree;
+    stream.opaque = buffer->memory;
+    err = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+                       8, Z_FILTERED);
+    if (err != Z_OK)
+        return_error(gs_error_VMerror);
+    out = buffer->data;
+    if (rect->p.y == 0) {
+        /* zlib header: 32K window, default compression. */
+        *out++ = 0x78;
+        *out++ = 0x9c;
+    }
+    stream.next_out = out;
+    stream.avail_out = buffer->size - (out - buffer->data) - 4;
+
+    buffer->adler = adler32(0L, NULL, 0);
+    for (y = 0, row = data; y < h && err == Z_OK; y++, row += raster) {
+        const byte *prev = (y > 0 ? row - raster : NULL);
+        uint sum, best = png_band_filter_row(buffer->rows[0], 0, row, prev, n, bpp);
+
+        for (type = 1; type <= (prev ? 4 : 1); type++) {
+            sum = png_band_filter_row(buffer->rows[1], type, row, prev, n, bpp);
+            if (sum < best) {
+                byte *t = buffer->rows[0];
+
+                buffer->rows[0] = buffer->rows[1];
+                buffer->rows[1] = t;
+                best = sum;
+            }
+        }
+        buffer->adler = adler32(buffer->adler, buffer->rows[0], n + 1);
+        stream.next_in = buffer->rows[0];
+        stream.avail_in = n + 1;
+        err = deflate(&stream, y < h - 1 ? Z_NO_FLUSH :
+                      buffer->last ? Z_FINISH : Z_SYNC_FLUSH);
+        if (err == Z_STREAM_END)
+            err = Z_OK;
+        if (stream.avail_in != 0)
+            err = Z_BUF_ERROR;
+    }
+    deflateEnd(&stream);
+    if (err != Z_OK)
+        return_error(gs_error_ioerror);
+
+    buffer->compressed = (out - buffer->data) + stream.total_out;
+    buffer->length = (uLong)(n + 1) * h;
+    return 0;
+}
+
+/* Runs on the main thread, in band order. */
+static int
+png_band_output(void *arg_, gx_device *dev, void *buffer_)
+{
+    png_band_arg_t *arg = (png_band_arg_t *)arg_;
+    png_band_buffer_t *buffer = (png_band_buffer_t *)buffer_;
+    int code;
+
+    if (buffer->compressed == 0)
+        return 0;
+    arg->adler = adler32_combine(arg->adler, buffer->adler, buffer->length);
+    if (buffer->last) {
+        png_band_put32(buffer->data + buffer->compressed, arg->adler);
+        buffer->compressed += 4;
+    }
+    code = png_band_put_chunk("IDAT", buffer->data, buffer->compressed, arg->file);
+    buffer->compressed = 0;
+    return code;
+}
+
+static bool
+png_band_output_ok(gx_device_png *pdev, png_byte color_type, int depth, int factor)
+{
+    return PRINTER_IS_CLIST((gx_device_printer *)pdev) &&
+           pdev->num_render_threads_requested > 0 && factor == 1 &&
+           ((color_type == PNG_COLOR_TYPE_GRAY && depth == 8) ||
+            (color_type == PNG_COLOR_TYPE_RGB && depth == 24) ||
+            (color_type == PNG_COLOR_TYPE_RGB_ALPHA && depth == 32));
+}
+
+/* Write the image data and the end of the file. */
+static int
+png_band_print_page(gx_device_png *pdev, FILE *file, int bpp, bool invert_alpha)
+{
+    gx_process_page_options_t process = { 0 };
+    png_band_arg_t arg;
+    int code;
+
+    arg.file = file;
+    arg.height = pdev->height;
+    arg.bpp = bpp;
+    arg.invert_alpha = invert_alpha;
+    arg.adler = adler32(0L, NULL, 0);
+
+    process.init_buffer_fn = png_band_init_buffer;
+    process.free_buffer_fn = png_band_free_buffer;
+    process.process_fn = png_band_process;
+    process.output_fn = png_band_output;
+    process.arg = &arg;
+
+    code = dev_proc(pdev, process_page)((gx_device *)pdev, &process);
+    if (code >= 0)
+        code = png_band_put_chunk("IEND", NULL, 0, file);
+    return code;
+}
+
 /* Write out a page in PNG format. */
 /* This routine is used for all formats. */
 static int
@@ -677,24 +978,28 @@ do_png_print_page(gx_device_png * pdev, FILE * file, bool monod)
     info_ptr->text = NULL;
 #endif
 
-    /* For simplicity of code, we always go through the downscaler. For
-     * non-supported depths, it will pass through with minimal performance
-     * hit. So ensure that we only trigger downscales when we need them.
-     */
-    code = gx_downscaler_init(&ds, (gx_device *)pdev, src_bpc, dst_bpc,
-                              depth/dst_bpc, factor, mfs, NULL, 0);
-    if (code >= 0)
-    {
-        /* Write the contents of the image. */
-        for (y = 0; y < height; y++) {
-            gx_downscaler_getbits(&ds, row, y);
-            png_write_rows(png_ptr, &row, 1);
+    if (!monod && png_band_output_ok(pdev, color_type, depth, factor)) {
+        code = png_band_print_page(pdev, file, depth >> 3, depth == 32);
+    } else {
+        /* For simplicity of code, we always go through the downscaler. For
+         * non-supported depths, it will pass through with minimal performance
+         * hit. So ensure that we only trigger downscales when we need them.
+         */
+        code = gx_downscaler_init(&ds, (gx_device *)pdev, src_bpc, dst_bpc,
+                                  depth/dst_bpc, factor, mfs, NULL, 0);
+        if (code >= 0)
+        {
+            /* Write the contents of the image. */
+            for (y = 0; y < height; y++) {
+                gx_downscaler_getbits(&ds, row, y);
+                png_write_rows(png_ptr, &row, 1);
+            }
+            gx_downscaler_fin(&ds);
         }
-        gx_downscaler_fin(&ds);
-    }
 
-    /* write the rest of the file */
-    png_write_end(png_ptr, info_ptr);
+        /* write the rest of the file */
+        png_write_end(png_ptr, info_ptr);
+    }
 
 #if PNG_LIBPNG_VER_MINOR >= 5
 #else
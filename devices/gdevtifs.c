@@ -23,6 +23,7 @@
 #include "gstypes.h"
 #include "gscdefs.h"
 #include "gdevprn.h"
+#include "gxgetbit.h"
 #include "minftrsz.h"
 #include "gxdownscale.h"
 #include "scommon.h"
@@ -440,6 +441,237 @@ int tiff_set_fields_for_printer(gx_device_printer *pdev,
     return 0;
 }
 
+/*
+ * Band parallel output. When a clist page is rendered with rendering
+ * threads, each band is compressed on the thread that rendered it, into
+ * strips of a TIFF kept in memory. The main thread then only has to copy
+ * the finished strips into the file, which it does in band order. No
+ * strip may straddle a band, so the rows per strip are reduced (if need
+ * be) to a divisor of the band height; otherwise the strips are exactly
+ * those that writing the page a scanline at a time would produce.
+ */
+bool
+tiff_strips_init(tiff_strips_t *strips, TIFF *tif)
+{
+    strips->tif = tif;
+    strips->checkpointed = false;
+    if (!TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &strips->width) ||
+        !TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &strips->height) ||
+        !TIFFGetField(tif, TIFFTAG_BITSPERSAMPLE, &strips->bits_per_sample) ||
+        !TIFFGetField(tif, TIFFTAG_SAMPLESPERPIXEL, &strips->samples_per_pixel) ||
+        !TIFFGetField(tif, TIFFTAG_ROWSPERSTRIP, &strips->rows_per_strip))
+        return false;
+    TIFFGetFieldDefaulted(tif, TIFFTAG_PHOTOMETRIC, &strips->photometric);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &strips->compression);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_FILLORDER, &strips->fill_order);
+    /* A single strip can't be split between threads. */
+    return strips->rows_per_strip < strips->height;
+}
+
+void
+tiff_strips_fit_band(tiff_strips_t *strips, int band_height)
+{
+    uint32 rps = strips->rows_per_strip;
+
+    if (band_height >= strips->height || band_height % rps == 0)
+        return;
+    if (rps > band_height)
+        rps = band_height;
+    else
+        while (band_height % rps != 0)
+            rps--;
+    strips->rows_per_strip = rps;
+    TIFFSetField(strips->tif, TIFFTAG_ROWSPERSTRIP, rps);
+}
+
+TIFF *
+tiff_strips_compress(gx_device_printer *dev, gs_memory_t *mem,
+                     const tiff_strips_t *strips, const byte *data,
+                     uint raster, int height)
+{
+    TIFF *band = tiff_to_memory(dev, mem, 0);
+    int y;
+
+    if (band == NULL)
+        return NULL;
+    TIFFSetField(band, TIFFTAG_IMAGEWIDTH, strips->width);
+    TIFFSetField(band, TIFFTAG_IMAGELENGTH, height);
+    TIFFSetField(band, TIFFTAG_BITSPERSAMPLE, strips->bits_per_sample);
+    TIFFSetField(band, TIFFTAG_SAMPLESPERPIXEL, strips->samples_per_pixel);
+    TIFFSetField(band, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(band, TIFFTAG_PHOTOMETRIC, strips->photometric);
+    TIFFSetField(band, TIFFTAG_FILLORDER, strips->fill_order);
+    TIFFSetField(band, TIFFTAG_COMPRESSION, strips->compression);
+    TIFFSetField(band, TIFFTAG_ROWSPERSTRIP, strips->rows_per_strip);
+
+    for (y = 0; y < height; y++) {
+        if (TIFFWriteScanline(band, (tdata_t)data, y, 0) < 0)
+            break;
+        data += raster;
+    }
+    if (y < height || !TIFFFlushData(band)) {
+        tiff_memory_close(band);
+        return NULL;
+    }
+    return band;
+}
+
+int
+tiff_strips_write(tiff_strips_t *strips, TIFF *band, int y)
+{
+    const byte *data;
+    uint64 *offsets, *counts;
+    uint32 first = y / strips->rows_per_strip;
+    uint32 i, n;
+    int code = 0;
+
+    if (!strips->checkpointed) {
+        strips->checkpointed = true;
+        if (TIFFCheckpointDirectory(strips->tif) < 0)
+            code = gs_note_error(gs_error_ioerror);
+    }
+    data = tiff_memory_data(band);
+    n = TIFFNumberOfStrips(band);
+    if (!TIFFGetField(band, TIFFTAG_STRIPOFFSETS, &offsets) ||
+        !TIFFGetField(band, TIFFTAG_STRIPBYTECOUNTS, &counts))
+        code = gs_note_error(gs_error_ioerror);
+    for (i = 0; i < n && code >= 0; i++) {
+        if (TIFFWriteRawStrip(strips->tif, first + i,
+                              (void *)(data + offsets[i]), counts[i]) < 0)
+            code = gs_note_error(gs_error_ioerror);
+    }
+    tiff_memory_close(band);
+    return code;
+}
+
+typedef struct tiff_band_arg_s {
+    gx_device_printer *pdev;
+    tiff_strips_t strips;
+} tiff_band_arg_t;
+
+typedef struct tiff_band_buffer_s {
+    gs_memory_t *memory;
+    TIFF *strips;               /* the compressed band, or NULL */
+    int y;
+} tiff_band_buffer_t;
+
+static int
+tiff_band_init_buffer(void *arg_, gx_device *dev, gs_memory_t *mem, int w, int h, void **pbuffer)
+{
+    tiff_band_arg_t *arg = (tiff_band_arg_t *)arg_;
+    tiff_band_buffer_t *buffer;
+
+    /* Called before any band is rendered, so the strip layout can still
+     * change. */
+    tiff_strips_fit_band(&arg->strips, h);
+
+    buffer = (tiff_band_buffer_t *)gs_alloc_bytes(mem, sizeof(tiff_band_buffer_t), "tiff_band_init_buffer");
+    *pbuffer = (void *)buffer;
+    if (buffer == NULL)
+        return_error(gs_error_VMerror);
+    buffer->memory = mem;
+    buffer->strips = NULL;
+    buffer->y = 0;
+    return 0;
+}
+
+static void
+tiff_band_free_buffer(void *arg, gx_device *dev, gs_memory_t *mem, void *buffer_)
+{
+    tiff_band_buffer_t *buffer = (tiff_band_buffer_t *)buffer_;
+
+    if (buffer == NULL)
+        return;
+    if (buffer->strips)
+        tiff_memory_close(buffer->strips);
+    gs_free_object(mem, buffer, "tiff_band_init_buffer");
+}
+
+/* Runs on the rendering thread: compress the band. */
+static int
+tiff_band_process(void *arg_, gx_device *dev, gx_device *bdev, const gs_int_rect *rect, void *buffer_)
+{
+    tiff_band_arg_t *arg = (tiff_band_arg_t *)arg_;
+    tiff_band_buffer_t *buffer = (tiff_band_buffer_t *)buffer_;
+    int w = rect->q.x - rect->p.x;
+    int h = rect->q.y - rect->p.y;
+    gs_get_bits_params_t params;
+    gs_int_rect my_rect;
+    int code;
+
+    if (h <= 0 || w <= 0)
+        return 0;
+
+    params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_CHUNKY | GB_RETURN_POINTER | GB_ALIGN_ANY | GB_OFFSET_0 | GB_RASTER_ANY;
+    my_rect.p.x = 0;
+    my_rect.p.y = 0;
+    my_rect.q.x = w;
+    my_rect.q.y = h;
+    code = dev_proc(bdev, get_bits_rectangle)(bdev, &my_rect, &params, NULL);
+    if (code < 0)
+        return code;
+
+    buffer->strips = tiff_strips_compress(arg->pdev, buffer->memory, &arg->strips,
+                                          params.data[0], gx_device_raster(bdev, true), h);
+    if (buffer->strips == NULL)
+        return_error(gs_error_ioerror);
+    buffer->y = rect->p.y;
+    return 0;
+}
+
+/* Runs on the main thread, in band order: copy the strips to the file. */
+static int
+tiff_band_output(void *arg_, gx_device *dev, void *buffer_)
+{
+    tiff_band_arg_t *arg = (tiff_band_arg_t *)arg_;
+    tiff_band_buffer_t *buffer = (tiff_band_buffer_t *)buffer_;
+    TIFF *strips = buffer->strips;
+
+    if (strips == NULL)
+        return 0;
+    buffer->strips = NULL;
+    return tiff_strips_write(&arg->strips, strips, buffer->y);
+}
+
+/* Can the page be written by tiff_band_print_page? The fields of the
+ * page must already be set. */
+static bool
+tiff_band_output_ok(gx_device_printer *dev, TIFF *tif)
+{
+    int nc = dev->color_info.num_components;
+    tiff_strips_t strips;
+
+    if (!PRINTER_IS_CLIST(dev) || dev->num_render_threads_requested < 1 ||
+        dev->color_info.depth != 8 * nc)
+        return false;
+    if (!tiff_strips_init(&strips, tif))
+        return false;
+    return strips.width == dev->width && strips.height == dev->height &&
+           strips.bits_per_sample == 8 && strips.samples_per_pixel == nc;
+}
+
+static int
+tiff_band_print_page(gx_device_printer *dev, TIFF *tif)
+{
+    gx_process_page_options_t process = { 0 };
+    tiff_band_arg_t arg;
+    int code;
+
+    arg.pdev = dev;
+    tiff_strips_init(&arg.strips, tif);
+
+    process.init_buffer_fn = tiff_band_init_buffer;
+    process.free_buffer_fn = tiff_band_free_buffer;
+    process.process_fn = tiff_band_process;
+    process.output_fn = tiff_band_output;
+    process.arg = &arg;
+
+    code = dev_proc(dev, process_page)((gx_device *)dev, &process);
+    if (code >= 0)
+        code = TIFFWriteDirectory(tif);
+    return code;
+}
+
 int
 tiff_print_page(gx_device_printer *dev, TIFF *tif, int min_feature_size)
 {
@@ -453,6 +685,9 @@ tiff_print_page(gx_device_printer *dev, TIFF *tif, int min_feature_size)
     int line_lag = 0;
     int filtered_count;
 
+    if (tiff_band_output_ok(dev, tif))
+        return tiff_band_print_page(dev, tif);
+
     data = gs_alloc_bytes(dev->memory, max_size, "tiff_print_page(data)");
     if (data == NULL)
         return_error(gs_error_VMerror);
@@ -542,6 +777,12 @@ tiff_downscale_and_print_page(gx_device_printer *dev, TIFF *tif, int factor,
     int height = dev->height/factor;
     gx_downscaler_t ds;
 
+    /* Without scaling, trapping or screening the 8 bit devices write out
+     * what was rendered, so the bands can be compressed as they come. */
+    if (factor == 1 && bpc == 8 && trap_w == 0 && trap_h == 0 && ets == 0 &&
+        tfdev->icclink == NULL && tiff_band_output_ok(dev, tif))
+        return tiff_band_print_page(dev, tif);
+
     code = TIFFCheckpointDirectory(tif);
     if (code < 0)
         return code;
@@ -61,6 +61,30 @@ int tiff_downscale_and_print_page(gx_device_printer *dev, TIFF *tif,
                                   int ets);
 void tiff_set_handlers (void);
 
+/*
+ * Band parallel output of a TIFF whose fields are set: tiff_strips_init
+ * reads the strip layout, returning false if the page has a single strip.
+ * Before any band is rendered, tiff_strips_fit_band reduces the rows per
+ * strip to a divisor of the band height. tiff_strips_compress runs on a
+ * rendering thread and compresses the rows of a band into a TIFF kept in
+ * memory, which tiff_strips_write then copies into the file (and closes),
+ * band by band in page order.
+ */
+typedef struct tiff_strips_s {
+    TIFF *tif;
+    uint32 width, height, rows_per_strip;
+    uint16 bits_per_sample, samples_per_pixel;
+    uint16 photometric, compression, fill_order;
+    bool checkpointed;
+} tiff_strips_t;
+
+bool tiff_strips_init(tiff_strips_t *strips, TIFF *tif);
+void tiff_strips_fit_band(tiff_strips_t *strips, int band_height);
+TIFF *tiff_strips_compress(gx_device_printer *dev, gs_memory_t *mem,
+                           const tiff_strips_t *strips, const byte *data,
+                           uint raster, int height);
+int tiff_strips_write(tiff_strips_t *strips, TIFF *band, int y);
+
 /*
  * Sets the compression tag for TIFF and updates the rows_per_strip tag to
  * reflect max_strip_size under the new compression scheme.
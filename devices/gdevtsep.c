@@ -49,6 +49,7 @@
 #include "gsicc_cache.h"
 #include "gxdevsop.h"
 #include "gsicc.h"
+#include "gsflip.h"
 
 /*
  * Some of the code in this module is based upon the gdevtfnx.c module.
@@ -1867,6 +1868,33 @@ done:
     return code;
 }
 
+/*
+ * If there are just 4 components, each going to a different one of C, M,
+ * Y and K at full strength, the CMYK equivalent is just those planes
+ * interleaved.  In that case return true, with the planes in CMYK order.
+ */
+static bool
+cmyk_map_is_planes(gs_get_bits_params_t *params, int num_comp,
+                   const cmyk_composite_map * cmyk_map,
+                   tiffsep_device * const tfdev, const byte **planes)
+{
+    int comp_num, ink;
+
+    if (num_comp != 4)
+        return false;
+    for (ink = 0; ink < 4; ink++)
+        planes[ink] = NULL;
+    for (comp_num = 0; comp_num < 4; comp_num++, cmyk_map++) {
+        ink = (cmyk_map->c == frac_1 ? 0 : cmyk_map->m == frac_1 ? 1 :
+               cmyk_map->y == frac_1 ? 2 : cmyk_map->k == frac_1 ? 3 : -1);
+        if (ink < 0 || planes[ink] != NULL ||
+            cmyk_map->c + cmyk_map->m + cmyk_map->y + cmyk_map->k != frac_1)
+            return false;
+        planes[ink] = params->data[tfdev->devn_params.separation_order_map[comp_num]];
+    }
+    return true;
+}
+
 /*
  * Build a CMYK equivalent to a raster line from planar buffer
  */
@@ -1880,8 +1908,15 @@ build_cmyk_raster_line_fromplanar(gs_get_bits_params_t *params, byte * dest,
     uint temp, cyan, magenta, yellow, black;
     cmyk_composite_map * cmyk_map_entry;
     byte *start = dest;
+    const byte *planes[4];
 
-    for (pixel = 0; pixel < width; pixel++) {
+    /* Plain CMYK needs no mixing, only interleaving. */
+    pixel = 0;
+    if (cmyk_map_is_planes(params, num_comp, cmyk_map, tfdev, planes)) {
+        image_flip_planes(dest, planes, 0, width, 4, 8);
+        pixel = width;
+    }
+    for (; pixel < width; pixel++) {
         cmyk_map_entry = cmyk_map;
         temp = *(params->data[tfdev->devn_params.separation_order_map[0]] + pixel);
         cyan = cmyk_map_entry->c * temp;
@@ -2270,6 +2305,218 @@ print_cmyk_equivalent_colors(tiffsep_device *tfdev, int num_comp, cmyk_composite
     return 0;
 }
 
+/*
+ * Band parallel output for tiffsep. When the page is rendered by threads
+ * and written at full resolution with 8 bits per component, each band's
+ * planes are turned into separation rows and composite CMYK rows on the
+ * thread that rendered it, and compressed there into strips for every
+ * output file (see tiff_strips_compress). The main thread then only
+ * copies the strips into the files, in band order.
+ */
+typedef struct tiffsep_band_arg_s {
+    tiffsep_device *tfdev;
+    int num_comp;
+    cmyk_composite_map *cmyk_map;
+    tiff_strips_t comp;
+    tiff_strips_t sep[GX_DEVICE_COLOR_MAX_COMPONENTS];
+} tiffsep_band_arg_t;
+
+typedef struct tiffsep_band_buffer_s {
+    gs_memory_t *memory;
+    byte *lines;                /* rows of the file being compressed */
+    TIFF *comp;                 /* the compressed band, or NULL */
+    TIFF *sep[GX_DEVICE_COLOR_MAX_COMPONENTS];
+    int y;
+} tiffsep_band_buffer_t;
+
+static int
+tiffsep_band_init_buffer(void *arg_, gx_device *dev, gs_memory_t *mem, int w, int h, void **pbuffer)
+{
+    tiffsep_band_arg_t *arg = (tiffsep_band_arg_t *)arg_;
+    tiffsep_band_buffer_t *buffer;
+    int comp_num;
+
+    /* Called before any band is rendered, so the strip layout can still
+     * change. */
+    tiff_strips_fit_band(&arg->comp, h);
+    if (!arg->tfdev->NoSeparationFiles)
+        for (comp_num = 0; comp_num < arg->num_comp; comp_num++)
+            tiff_strips_fit_band(&arg->sep[comp_num], h);
+
+    buffer = (tiffsep_band_buffer_t *)gs_alloc_bytes(mem, sizeof(tiffsep_band_buffer_t), "tiffsep_band_init_buffer");
+    *pbuffer = (void *)buffer;
+    if (buffer == NULL)
+        return_error(gs_error_VMerror);
+    memset(buffer, 0, sizeof(*buffer));
+    buffer->memory = mem;
+    buffer->lines = gs_alloc_bytes(mem, (size_t)w * NUM_CMYK_COMPONENTS * h, "tiffsep_band_init_buffer(lines)");
+    if (buffer->lines == NULL) {
+        gs_free_object(mem, buffer, "tiffsep_band_init_buffer");
+        *pbuffer = NULL;
+        return_error(gs_error_VMerror);
+    }
+    return 0;
+}
+
+static void
+tiffsep_band_free_buffer(void *arg_, gx_device *dev, gs_memory_t *mem, void *buffer_)
+{
+    tiffsep_band_arg_t *arg = (tiffsep_band_arg_t *)arg_;
+    tiffsep_band_buffer_t *buffer = (tiffsep_band_buffer_t *)buffer_;
+    int comp_num;
+
+    if (buffer == NULL)
+        return;
+    for (comp_num = 0; comp_num < arg->num_comp; comp_num++)
+        if (buffer->sep[comp_num])
+            tiff_memory_close(buffer->sep[comp_num]);
+    if (buffer->comp)
+        tiff_memory_close(buffer->comp);
+    gs_free_object(mem, buffer->lines, "tiffsep_band_init_buffer(lines)");
+    gs_free_object(mem, buffer, "tiffsep_band_init_buffer");
+}
+
+/* Runs on the rendering thread: compress the band for every file. */
+static int
+tiffsep_band_process(void *arg_, gx_device *dev, gx_device *bdev, const gs_int_rect *rect, void *buffer_)
+{
+    tiffsep_band_arg_t *arg = (tiffsep_band_arg_t *)arg_;
+    tiffsep_band_buffer_t *buffer = (tiffsep_band_buffer_t *)buffer_;
+    tiffsep_device *tfdev = arg->tfdev;
+    gx_device_printer *pdev = (gx_device_printer *)tfdev;
+    int w = rect->q.x - rect->p.x;
+    int h = rect->q.y - rect->p.y;
+    int num_comp = arg->num_comp;
+    uint raster = gx_device_raster_plane(bdev, NULL);
+    gs_get_bits_params_t params, row_params;
+    gs_int_rect my_rect;
+    byte *dest;
+    int code, comp_num, x, y;
+
+    if (h <= 0 || w <= 0)
+        return 0;
+
+    params.options = GB_COLORS_NATIVE | GB_ALPHA_NONE | GB_PACKING_PLANAR | GB_RETURN_POINTER | GB_ALIGN_ANY | GB_OFFSET_0 | GB_RASTER_ANY;
+    my_rect.p.x = 0;
+    my_rect.p.y = 0;
+    my_rect.q.x = w;
+    my_rect.q.y = h;
+    code = dev_proc(bdev, get_bits_rectangle)(bdev, &my_rect, &params, NULL);
+    if (code < 0)
+        return code;
+    buffer->y = rect->p.y;
+
+    /* Write separation data (tiffgray format) */
+    if (!tfdev->NoSeparationFiles) {
+        for (comp_num = 0; comp_num < num_comp; comp_num++) {
+            const byte *src = params.data[comp_num];
+
+            dest = buffer->lines;
+            for (y = 0; y < h; y++, src += raster)
+                for (x = 0; x < w; x++)
+                    *dest++ = MAX_COLOR_VALUE - src[x];    /* Gray is additive */
+            buffer->sep[comp_num] = tiff_strips_compress(pdev, buffer->memory,
+                                        &arg->sep[comp_num], buffer->lines, w, h);
+            if (buffer->sep[comp_num] == NULL)
+                return_error(gs_error_ioerror);
+        }
+    }
+    /* Write CMYK equivalent data */
+    row_params = params;
+    dest = buffer->lines;
+    for (y = 0; y < h; y++, dest += w * NUM_CMYK_COMPONENTS) {
+        build_cmyk_raster_line_fromplanar(&row_params, dest, w, num_comp,
+                                          arg->cmyk_map, 0, tfdev);
+        for (comp_num = 0; comp_num < num_comp; comp_num++)
+            row_params.data[comp_num] += raster;
+    }
+    buffer->comp = tiff_strips_compress(pdev, buffer->memory, &arg->comp,
+                                        buffer->lines, w * NUM_CMYK_COMPONENTS, h);
+    if (buffer->comp == NULL)
+        return_error(gs_error_ioerror);
+    return 0;
+}
+
+/* Runs on the main thread, in band order: copy the strips to the files. */
+static int
+tiffsep_band_output(void *arg_, gx_device *dev, void *buffer_)
+{
+    tiffsep_band_arg_t *arg = (tiffsep_band_arg_t *)arg_;
+    tiffsep_band_buffer_t *buffer = (tiffsep_band_buffer_t *)buffer_;
+    int comp_num, code = 0, code1;
+
+    for (comp_num = 0; comp_num < arg->num_comp; comp_num++) {
+        if (buffer->sep[comp_num]) {
+            code1 = tiff_strips_write(&arg->sep[comp_num], buffer->sep[comp_num], buffer->y);
+            buffer->sep[comp_num] = NULL;
+            if (code1 < 0)
+                code = code1;
+        }
+    }
+    if (buffer->comp) {
+        code1 = tiff_strips_write(&arg->comp, buffer->comp, buffer->y);
+        buffer->comp = NULL;
+        if (code1 < 0)
+            code = code1;
+    }
+    return code;
+}
+
+/*
+ * Can the page data be written by tiffsep_band_print_page? The fields of
+ * all the files must already be set. Scaling, trapping, output color
+ * management and fewer than 8 bits per component all need the whole page
+ * to go through the downscaler, as does a SeparationOrder.
+ */
+static bool
+tiffsep_band_output_ok(tiffsep_device *tfdev, int num_comp, int num_order,
+                       tiffsep_band_arg_t *arg)
+{
+    gx_device_printer *pdev = (gx_device_printer *)tfdev;
+    int comp_num;
+
+    if (!PRINTER_IS_CLIST(pdev) || pdev->num_render_threads_requested < 1 ||
+        tfdev->downscale.downscale_factor > 1 || tfdev->BitsPerComponent != 8 ||
+        tfdev->downscale.trap_w != 0 || tfdev->downscale.trap_h != 0 ||
+        tfdev->icclink != NULL || num_order > 0)
+        return false;
+    if (!tiff_strips_init(&arg->comp, tfdev->tiff_comp) ||
+        arg->comp.width != pdev->width || arg->comp.height != pdev->height ||
+        arg->comp.bits_per_sample != 8 ||
+        arg->comp.samples_per_pixel != NUM_CMYK_COMPONENTS)
+        return false;
+    if (!tfdev->NoSeparationFiles) {
+        for (comp_num = 0; comp_num < num_comp; comp_num++) {
+            tiff_strips_t *sep = &arg->sep[comp_num];
+
+            if (!tiff_strips_init(sep, tfdev->tiff[comp_num]) ||
+                sep->width != pdev->width || sep->height != pdev->height ||
+                sep->bits_per_sample != 8 || sep->samples_per_pixel != 1)
+                return false;
+        }
+    }
+    return true;
+}
+
+static int
+tiffsep_band_print_page(tiffsep_device *tfdev, int num_comp,
+                        cmyk_composite_map *cmyk_map, tiffsep_band_arg_t *arg)
+{
+    gx_process_page_options_t process = { 0 };
+
+    arg->tfdev = tfdev;
+    arg->num_comp = num_comp;
+    arg->cmyk_map = cmyk_map;
+
+    process.init_buffer_fn = tiffsep_band_init_buffer;
+    process.free_buffer_fn = tiffsep_band_free_buffer;
+    process.process_fn = tiffsep_band_process;
+    process.output_fn = tiffsep_band_output;
+    process.arg = arg;
+
+    return dev_proc(tfdev, process_page)((gx_device *)tfdev, &process);
+}
+
 /*
  * Output the image data for the tiff separation (tiffsep) device.  The data
  * for the tiffsep device is written in separate planes to separate files.
@@ -2444,6 +2691,12 @@ tiffsep_print_page(gx_device_printer * pdev, FILE * file)
         byte * sep_line;
         int plane_index;
         int offset_plane = 0;
+        tiffsep_band_arg_t band_arg;
+
+        if (tiffsep_band_output_ok(tfdev, num_comp, num_order, &band_arg)) {
+            code = tiffsep_band_print_page(tfdev, num_comp, cmyk_map, &band_arg);
+            goto write_directories;
+        }
 
         sep_line =
             gs_alloc_bytes(pdev->memory, cmyk_raster, "tiffsep_print_page");
@@ -2600,6 +2853,7 @@ cleanup:
             gx_downscaler_fin(&ds);
             gs_free_object(pdev->memory, sep_line, "tiffsep_print_page");
         }
+write_directories:
         code1 = code;
         if (!tfdev->NoSeparationFiles) {
             for (comp_num = 0; comp_num < num_comp; comp_num++) {
@@ -115,6 +115,16 @@ single-probe lookups in this dictionary.  We also cache a value that
 allows us to do a fast check for stores into the top dictionary
 (writability + space check).
 
+Names in the third state that miss the top dictionary are looked up
+through a direct-mapped cache in the name table, indexed by name index.
+Each entry records the value pointer and the cache generation at the time
+of the lookup.  The generation is advanced by every change to the
+dictionary stack (dstack_set_top), by restore and by garbage collection,
+which invalidates all entries at once; creating or deleting a key clears
+just that name's entry.  This is a simplified form of the "improved
+design" below: it gives up the restoration stack R in exchange for
+needing no work in begin/end beyond bumping the generation.
+
 Improved design
 ===============
 
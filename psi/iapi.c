@@ -32,6 +32,7 @@
 #include "gslibctx.h"
 #include "gp.h"
 #include "gsargs.h"
+#include "idisp.h"
 
 #ifndef GS_THREADSAFE
 /* Number of threads to allow per process. Unless GS_THREADSAFE is defined
@@ -151,6 +152,7 @@ gsapi_delete_instance(void *instance)
         ctx->stderr_fn = NULL;
         ctx->poll_fn = NULL;
         minst->display = NULL;
+        minst->band = NULL;
 
         gs_free_object(mem, minst, "init_main_instance");
 
@@ -203,6 +205,27 @@ gsapi_set_display_callback(void *instance, display_callback *callback)
     return 0;
 }
 
+/* Set the band device callback structure */
+GSDLLEXPORT int GSDLLAPI
+gsapi_set_band_callback(void *instance, band_callback *callback)
+{
+    gs_lib_ctx_t *ctx = (gs_lib_ctx_t *)instance;
+    if (instance == NULL)
+        return gs_error_Fatal;
+    get_minst_from_memory(ctx->memory)->band = callback;
+    return 0;
+}
+
+/* Render tiles of the page kept by the band device */
+GSDLLEXPORT int GSDLLAPI
+gsapi_render_tiles(void *instance, band_tile *tiles, int count)
+{
+    gs_lib_ctx_t *ctx = (gs_lib_ctx_t *)instance;
+    if (instance == NULL)
+        return gs_error_Fatal;
+    return band_render_tiles(get_minst_from_memory(ctx->memory), tiles, count);
+}
+
 /* Set/Get the default device list string */
 GSDLLEXPORT int GSDLLAPI
 gsapi_set_default_device_list(void *instance, char *list, int listlen)
@@ -112,6 +112,16 @@ extern "C" {
 typedef struct display_callback_s display_callback;
 #endif
 
+#ifndef band_callback_DEFINED
+# define band_callback_DEFINED
+typedef struct band_callback_s band_callback;
+#endif
+
+#ifndef band_tile_DEFINED
+# define band_tile_DEFINED
+typedef struct band_tile_s band_tile;
+#endif
+
 typedef struct gsapi_revision_s {
     const char *product;
     const char *copyright;
@@ -197,6 +207,23 @@ GSDLLEXPORT int GSDLLAPI gsapi_set_poll(void *instance,
 GSDLLEXPORT int GSDLLAPI gsapi_set_display_callback(
    void *instance, display_callback *callback);
 
+/* Set the band device callback structure.
+ * If one of the band devices (bandgray, bandrgb, bandcmyk) is used,
+ * this must be called after gsapi_new_instance() and before
+ * gsapi_init_with_args().
+ * See gdevband.h for more details.
+ */
+GSDLLEXPORT int GSDLLAPI gsapi_set_band_callback(
+   void *instance, band_callback *callback);
+
+/* Render tiles of the page kept by a band device run with -dKeepPage.
+ * This may be called from band_page_end, or between calls that run
+ * PostScript, until the next page is output.
+ * See gdevband.h for more details.
+ */
+GSDLLEXPORT int GSDLLAPI gsapi_render_tiles(
+   void *instance, band_tile *tiles, int count);
+
 /* Set the string containing the list of default device names
  * for example "display x11alpha x11 bbox". Allows the calling
  * application to influence which device(s) gs will try in order
@@ -510,10 +510,13 @@ dict_put(ref * pdref /* t_dictionary */ , const ref * pkey, const ref * pvalue,
         }
         ref_save_in(mem, pdref, &pdict->count, "dict_put(count)");
         pdict->count.value.intval++;
-        /* If the key is a name, update its 1-element cache. */
+        /* If the key is a name, update its 1-element cache, */
+        /* and forget any lookup it might now shadow. */
         if (r_has_type(pkey, t_name)) {
             name *pname = pkey->value.pname;
 
+            names_lookup_cache_clear_name(pmem->gs_lib_ctx->gs_name_table,
+                                          name_index(pmem, pkey));
             if (pname->pvalue == pv_no_defn &&
                 CAN_SET_PVALUE_CACHE(pds, pdref, mem)
                 ) {		/* Set the cache. */
@@ -578,6 +581,18 @@ dict_undef(ref * pdref, const ref * pkey, dict_stack_t *pds)
     pdict = pdref->value.pdict;
     index = pvslot - pdict->values.value.refs;
     mem = dict_memory(pdict);
+    /*
+     * Forget any lookup cache entry for the name.  Use the stored key,
+     * since pkey may be a string.
+     */
+    {
+        ref key;
+
+        array_get(dict_mem(pdict), &pdict->keys, (long)index, &key);
+        if (r_has_type(&key, t_name))
+            names_lookup_cache_clear_name(dict_mem(pdict)->gs_lib_ctx->gs_name_table,
+                                          name_index(dict_mem(pdict), &key));
+    }
     if (dict_is_packed(pdict)) {
         ref_packed *pkp = pdict->keys.value.writable_packed + index;
         bool must_save = ref_must_save_in(mem, &pdict->keys);
@@ -43,10 +43,14 @@
 #include "gxdevice.h"
 #include "gxdevmem.h"
 #include "idisp.h"
+#include "gdevprn.h"
 #include "gdevdevn.h"
 #include "gsequivc.h"
 #include "gdevdsp.h"
 #include "gdevdsp2.h"
+#include "gxdownscale.h"
+#include "gdevband.h"
+#include "gdevband2.h"
 
 int
 display_set_callback(gs_main_instance *minst, display_callback *callback)
@@ -110,3 +114,60 @@ display_set_callback(gs_main_instance *minst, display_callback *callback)
     pop(1);	/* boolean */
     return 0;
 }
+
+int
+band_set_callback(gs_main_instance *minst, band_callback *callback)
+{
+    static const char *const band_devices[] = {
+        "bandgray", "bandrgb", "bandcmyk"
+    };
+    char getband[80];
+    i_ctx_t *i_ctx_p;
+    int code, i;
+    int exit_code = 0;
+    os_ptr op;
+    gx_device *dev;
+
+    for (i = 0; i < countof(band_devices); i++) {
+        /* As for the display device, find (and instantiate) the device
+         * if it was included in Ghostscript, else leave false.
+         */
+        gs_sprintf(getband,
+          "devicedict /%s known dup { /%s finddevice exch } if",
+          band_devices[i], band_devices[i]);
+        code = gs_main_run_string(minst, getband, 0, &exit_code,
+            &minst->error_object);
+        if (code < 0)
+           return code;
+
+        i_ctx_p = minst->i_ctx_p;	/* run_string may change i_ctx_p if GC */
+        op = osp;
+        check_type(*op, t_boolean);
+        if (op->value.boolval) {
+            check_read_type(op[-1], t_device);
+            dev = op[-1].value.pdevice;
+
+            /* The callbacks are only used to output a page, so unlike
+             * the display device this one need not be reopened, which
+             * would discard the page erased by setpagedevice.
+             */
+            while (dev->child)
+                dev = dev->child;
+            ((gx_device_band *)dev)->callback = callback;
+            pop(1);	/* device */
+        }
+        pop(1);	/* boolean */
+    }
+    return 0;
+}
+
+int
+band_render_tiles(gs_main_instance *minst, band_tile *tiles, int count)
+{
+    gx_device *dev;
+
+    if (minst->i_ctx_p == NULL)
+        return_error(gs_error_undefined);
+    dev = gs_currentdevice(minst->i_ctx_p->pgs);
+    return gdev_band_render_tiles(dev, tiles, count);
+}
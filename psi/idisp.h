@@ -26,4 +26,20 @@ typedef struct display_callback_s display_callback;
 /* Called from imain.c to set the display callback in the device instance. */
 int display_set_callback(gs_main_instance *minst, display_callback *callback);
 
+#ifndef band_callback_DEFINED
+# define band_callback_DEFINED
+typedef struct band_callback_s band_callback;
+#endif
+
+/* Called from imain.c to set the callback in the band device instances. */
+int band_set_callback(gs_main_instance *minst, band_callback *callback);
+
+#ifndef band_tile_DEFINED
+# define band_tile_DEFINED
+typedef struct band_tile_s band_tile;
+#endif
+
+/* Called from iapi.c to render tiles of the page kept by the band device. */
+int band_render_tiles(gs_main_instance *minst, band_tile *tiles, int count);
+
 #endif /* idisp_INCLUDED */
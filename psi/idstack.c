@@ -29,6 +29,10 @@
                         "idicttpl.h" is included below.
 */
 
+/* Get the name table that holds the lookup cache. */
+#define dstack_name_table(pds)\
+  (((gs_memory_t *)(pds)->stack.memory)->gs_lib_ctx->gs_name_table)
+
 /* Debugging statistics */
 #if defined(DEBUG) && !defined(GS_THREADSAFE)
 #include "idebug.h"
@@ -37,6 +41,9 @@ struct stats_dstack_s {
     long lookups;		/* total lookups */
     long probes[2];		/* successful lookups on 1 or 2 probes */
     long depth[MAX_STATS_DEPTH + 1]; /* stack depth of lookups requiring search */
+    long cache_hits;		/* lookups satisfied by the lookup cache */
+    long cache_misses;		/* lookups that had to search */
+    long cache_flushes;		/* generation changes */
 } stats_dstack;
 # define INCR(v) (++stats_dstack.v)
 #else
@@ -66,10 +73,14 @@ dstack_find_name_by_index(dict_stack_t * pds, uint nidx)
             )
             INCR(probes[1]);
     }
-    if (gs_debug_c('d') && !(stats_dstack.lookups % 1000))
+    if (gs_debug_c('d') && !(stats_dstack.lookups % 1000)) {
         dlprintf3("[d]lookups=%ld probe1=%ld probe2=%ld\n",
                   stats_dstack.lookups, stats_dstack.probes[0],
                   stats_dstack.probes[1]);
+        dlprintf3("[d]cache hits=%ld misses=%ld flushes=%ld\n",
+                  stats_dstack.cache_hits, stats_dstack.cache_misses,
+                  stats_dstack.cache_flushes);
+    }
     return pvalue;
 }
 #define dstack_find_name_by_index real_dstack_find_name_by_index
@@ -97,11 +108,11 @@ dstack_dict_is_permanent(const dict_stack_t * pds, const ref * pdref)
 }
 
 /*
- * Look up a name on the dictionary stack.
+ * Search the dictionary stack for a name, bypassing the lookup cache.
  * Return the pointer to the value if found, 0 if not.
  */
-ref *
-dstack_find_name_by_index(dict_stack_t * pds, uint nidx)
+static ref *
+dstack_search_name_by_index(dict_stack_t * pds, uint nidx)
 {
     ds_ptr pdref = pds->stack.p;
 
@@ -198,6 +209,34 @@ dstack_find_name_by_index(dict_stack_t * pds, uint nidx)
 #undef hash
 }
 
+/*
+ * Look up a name on the dictionary stack.
+ * Return the pointer to the value if found, 0 if not.
+ * Successful searches are remembered in the name table's lookup cache
+ * (see inamedef.h); failures are not, since they normally end in an
+ * undefined error.
+ */
+ref *
+dstack_find_name_by_index(dict_stack_t * pds, uint nidx)
+{
+    name_table *nt = dstack_name_table(pds);
+    name_lookup_cache_entry *pce = names_lookup_cache_entry(nt, nidx);
+    ref *pvalue;
+
+    if (pce->nidx == nidx && pce->generation == nt->lookup_generation) {
+        INCR(cache_hits);
+        return pce->pvalue;
+    }
+    INCR(cache_misses);
+    pvalue = dstack_search_name_by_index(pds, nidx);
+    if (pvalue != 0) {
+        pce->nidx = nidx;
+        pce->generation = nt->lookup_generation;
+        pce->pvalue = pvalue;
+    }
+    return pvalue;
+}
+
 /* Set the cached values computed from the top entry on the dstack. */
 /* See idstack.h for details. */
 static const ref_packed no_packed_keys[2] =
@@ -210,6 +249,9 @@ dstack_set_top(dict_stack_t * pds)
 
     if_debug3('d', "[d]dsp = 0x%lx -> 0x%lx, key array type = %d\n",
               (ulong) dsp, (ulong) pdict, r_type(&pdict->keys));
+    /* Any change to the stack may change the result of name lookups. */
+    names_invalidate_lookup_cache(dstack_name_table(pds));
+    INCR(cache_flushes);
     if (dict_is_packed(pdict) &&
         r_has_attr(dict_access_ref(dsp), a_read)
         ) {
@@ -31,6 +31,7 @@
 #include "igcstr.h"
 #include "inamedef.h"
 #include "opdef.h"		/* for marking oparray names */
+#include "gxsync.h"		/* for parallel relocation */
 
 /* Define whether to force all garbage collections to be global. */
 static const bool I_FORCE_GLOBAL_GC = false;
@@ -76,6 +77,8 @@ static bool gc_trace_finish(gc_state_t *);
 static void gc_clear_reloc(clump_t *);
 static void gc_objects_set_reloc(gc_state_t * gcst, clump_t *);
 static void gc_do_reloc(clump_t *, gs_ref_memory_t *, gc_state_t *);
+static void gc_do_reloc_clumps(gs_ref_memory_t **, int, int, gc_state_t *,
+                               int);
 static void gc_objects_compact(clump_t *, gc_state_t *);
 static void gc_free_empty_clumps(gs_ref_memory_t *);
 
@@ -232,6 +235,7 @@ gs_gc_reclaim(vm_spaces * pspaces, bool global)
     state.spaces = spaces;
     state.min_collect = min_collect_vm_space << r_space_shift;
     state.relocating_untraced = false;
+    state.concurrent = false;
     state.heap = state.loc.memory->non_gc_memory;
     state.ntable = state.heap->gs_lib_ctx->gs_name_table;
 
@@ -442,12 +446,18 @@ gs_gc_reclaim(vm_spaces * pspaces, bool global)
 
     /* Relocate pointers. */
 
+    if (space_global->gc_status.num_threads > 0) {
+        /* Relocating threads can't splay the clump trees, see gc_locate. */
+        for_spaces(ispace, max_trace)
+            for_space_mems(ispace, mem)
+                clump_splay_balance(mem);
+    }
     state.relocating_untraced = true;
-    for_clumps(ispace, min_collect - 1, mem, cp, &sw)
-        gc_do_reloc(cp, mem, &state);
+    gc_do_reloc_clumps(space_memories, 1, min_collect - 1, &state,
+                       space_global->gc_status.num_threads);
     state.relocating_untraced = false;
-    for_collected_clumps(ispace, mem, cp, &sw)
-        gc_do_reloc(cp, mem, &state);
+    gc_do_reloc_clumps(space_memories, min_collect, max_trace, &state,
+                       space_global->gc_status.num_threads);
 
     end_phase(state.heap,"relocate clumps");
 
@@ -1251,6 +1261,126 @@ gc_do_reloc(clump_t * cp, gs_ref_memory_t * mem, gc_state_t * pstate)
     END_OBJECTS_SCAN
 }
 
+/*
+ * Relocating the pointers in a clump only writes the objects in that
+ * clump, and only reads the relocation information that
+ * gc_objects_set_reloc and gc_strings_set_reloc have already computed for
+ * all the clumps.  So once that phase is complete, the clumps can be
+ * relocated in any order, including concurrently.  Each thread works with
+ * its own copy of the GC state (which caches the last clump located), and
+ * locates clumps without reorganizing the splay trees.
+ */
+typedef struct gc_reloc_item_s {
+    clump_t *cp;
+    gs_ref_memory_t *mem;
+} gc_reloc_item_t;
+typedef struct gc_reloc_job_s {
+    gc_reloc_item_t *items;
+    uint count;
+    uint next;			/* next item to relocate, */
+                                /* protected by lock */
+    gx_monitor_t *lock;
+} gc_reloc_job_t;
+typedef struct gc_reloc_worker_s {
+    gc_reloc_job_t *job;
+    gc_state_t state;
+    gp_thread_id thread;
+} gc_reloc_worker_t;
+
+static void
+gc_reloc_worker(void *arg)
+{
+    gc_reloc_worker_t *pw = (gc_reloc_worker_t *)arg;
+    gc_reloc_job_t *job = pw->job;
+
+    for (;;) {
+        uint i;
+
+        gx_monitor_enter(job->lock);
+        i = job->next;
+        if (i < job->count)
+            job->next++;
+        gx_monitor_leave(job->lock);
+        if (i >= job->count)
+            break;
+        gc_do_reloc(job->items[i].cp, job->items[i].mem, &pw->state);
+    }
+}
+
+/* Relocate the pointers in all the clumps of spaces min_space..max_space, */
+/* using up to num_threads additional threads. */
+static void
+gc_do_reloc_clumps(gs_ref_memory_t **space_memories, int min_space,
+                   int max_space, gc_state_t *pstate, int num_threads)
+{
+    gs_memory_t *heap = pstate->heap;
+    gs_ref_memory_t *mem;
+    clump_t *cp;
+    clump_splay_walker sw;
+    gc_reloc_job_t job;
+    gc_reloc_worker_t *workers = 0;
+    int ispace, i, started = 0;
+
+    job.items = 0;
+    job.count = 0;
+    job.next = 0;
+    job.lock = 0;
+    if (num_threads > 0) {
+        for (ispace = min_space; ispace <= max_space; ++ispace)
+            for_space_clumps(ispace, mem, cp, &sw)
+                job.count++;
+        if (job.count > 1) {
+            if (num_threads > job.count - 1)
+                num_threads = job.count - 1;
+            job.items = (gc_reloc_item_t *)
+                gs_alloc_byte_array(heap, job.count, sizeof(gc_reloc_item_t),
+                                    "gc_do_reloc_clumps(items)");
+            workers = (gc_reloc_worker_t *)
+                gs_alloc_byte_array(heap, num_threads + 1,
+                                    sizeof(gc_reloc_worker_t),
+                                    "gc_do_reloc_clumps(workers)");
+            job.lock = gx_monitor_label(gx_monitor_alloc(heap), "gc reloc");
+        }
+    }
+    if (job.items == 0 || workers == 0 || job.lock == 0) {
+        /* Relocate serially. */
+        for (ispace = min_space; ispace <= max_space; ++ispace)
+            for_space_clumps(ispace, mem, cp, &sw)
+                gc_do_reloc(cp, mem, pstate);
+        goto done;
+    }
+    i = 0;
+    for (ispace = min_space; ispace <= max_space; ++ispace)
+        for_space_clumps(ispace, mem, cp, &sw) {
+            job.items[i].cp = cp;
+            job.items[i].mem = mem;
+            ++i;
+        }
+    /* workers[0] is this thread. */
+    for (i = 0; i <= num_threads; ++i) {
+        workers[i].job = &job;
+        workers[i].state = *pstate;
+        workers[i].state.loc.cp = 0;
+        workers[i].state.concurrent = true;
+    }
+    for (i = 1; i <= num_threads; ++i) {
+        if (gp_thread_start(gc_reloc_worker, &workers[i],
+                            &workers[i].thread) < 0)
+            break;
+        gp_thread_label(workers[i].thread, "gc reloc");
+        started = i;
+    }
+    if_debug2m('6', heap, "[6]relocating %u clumps with %d threads\n",
+               job.count, started + 1);
+    gc_reloc_worker(&workers[0]);
+    for (i = 1; i <= started; ++i)
+        gp_thread_finish(workers[i].thread);
+ done:
+    gx_monitor_free(job.lock);
+    gs_free_object(heap, workers, "gc_do_reloc_clumps(workers)");
+    gs_free_object(heap, job.items, "gc_do_reloc_clumps(items)");
+}
+
 /* Print pointer relocation if debugging. */
 /* We have to provide this procedure even if DEBUG is not defined, */
 /* in case one of the other GC modules was compiled with DEBUG. */
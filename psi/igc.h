@@ -67,6 +67,8 @@ struct gc_state_s {
     gs_memory_t *heap;	/* for extending mark stack */
     name_table *ntable;		/* (implicitly referenced by names) */
     gs_memory_t *cur_mem;
+    bool concurrent;		/* if true, other threads are */
+    /* relocating at the same time, see gc_locate */
 #ifdef DEBUG
     clump_t *container;
 #endif
@@ -40,6 +40,12 @@ static int do_validate_object(const obj_header_t * ptr, const clump_t * cp,
 
 /* ================ Locating ================ */
 
+/* While other threads are relocating, we must not reorganize the splay */
+/* trees they may be searching. */
+#define gc_clump_locate(ptr, gcst)\
+  ((gcst)->concurrent ? clump_find(ptr, &(gcst)->loc) :\
+   clump_locate(ptr, &(gcst)->loc))
+
 /* Locate a pointer in the clumps of a space being collected. */
 /* This is only used for string garbage collection and for debugging. */
 clump_t *
@@ -48,7 +54,7 @@ gc_locate(const void *ptr, gc_state_t * gcst)
     gs_ref_memory_t *mem;
     gs_ref_memory_t *other;
 
-    if (clump_locate(ptr, &gcst->loc))
+    if (gc_clump_locate(ptr, gcst))
         return gcst->loc.cp;
     mem = gcst->loc.memory;
 
@@ -62,7 +68,7 @@ gc_locate(const void *ptr, gc_state_t * gcst)
         ) {
         gcst->loc.memory = other;
         gcst->loc.cp = 0;
-        if (clump_locate(ptr, &gcst->loc))
+        if (gc_clump_locate(ptr, gcst))
             return gcst->loc.cp;
     }
 
@@ -76,13 +82,13 @@ gc_locate(const void *ptr, gc_state_t * gcst)
         gcst->loc.memory = other =
             (mem->space == avm_local ? gcst->space_global : gcst->space_local);
         gcst->loc.cp = 0;
-        if (clump_locate(ptr, &gcst->loc))
+        if (gc_clump_locate(ptr, gcst))
             return gcst->loc.cp;
         /* Try its stable allocator. */
         if (other->stable_memory != (const gs_memory_t *)other) {
             gcst->loc.memory = (gs_ref_memory_t *)other->stable_memory;
             gcst->loc.cp = 0;
-            if (clump_locate(ptr, &gcst->loc))
+            if (gc_clump_locate(ptr, gcst))
                 return gcst->loc.cp;
             gcst->loc.memory = other;
         }
@@ -90,7 +96,7 @@ gc_locate(const void *ptr, gc_state_t * gcst)
         while (gcst->loc.memory->saved != 0) {
             gcst->loc.memory = &gcst->loc.memory->saved->state;
             gcst->loc.cp = 0;
-            if (clump_locate(ptr, &gcst->loc))
+            if (gc_clump_locate(ptr, gcst))
                 return gcst->loc.cp;
         }
     }
@@ -103,7 +109,7 @@ gc_locate(const void *ptr, gc_state_t * gcst)
     if (mem != gcst->space_system) {
         gcst->loc.memory = gcst->space_system;
         gcst->loc.cp = 0;
-        if (clump_locate(ptr, &gcst->loc))
+        if (gc_clump_locate(ptr, gcst))
             return gcst->loc.cp;
     }
 
@@ -119,7 +125,7 @@ gc_locate(const void *ptr, gc_state_t * gcst)
         if (other->stable_memory != (const gs_memory_t *)other) {
             gcst->loc.memory = (gs_ref_memory_t *)other->stable_memory;
             gcst->loc.cp = 0;
-            if (clump_locate(ptr, &gcst->loc))
+            if (gc_clump_locate(ptr, gcst))
                 return gcst->loc.cp;
         }
         gcst->loc.memory = other;
@@ -134,7 +140,7 @@ gc_locate(const void *ptr, gc_state_t * gcst)
     for (;;) {
         if (gcst->loc.memory != mem) {	/* don't do twice */
             gcst->loc.cp = 0;
-            if (clump_locate(ptr, &gcst->loc))
+            if (gc_clump_locate(ptr, gcst))
                 return gcst->loc.cp;
         }
         if (gcst->loc.memory->saved == 0)
@@ -204,6 +210,7 @@ ialloc_validate_spaces(const gs_dual_memory_t * dmem)
     state.spaces = dmem->spaces;
     state.loc.memory = state.space_local;
     state.loc.cp = 0;
+    state.concurrent = false;
     state.heap = dmem->current->non_gc_memory;  /* valid 'heap' needed for printing */
 
     /* Save everything we need to reset temporarily. */
@@ -290,6 +290,9 @@ int gs_main_init2aux(gs_main_instance * minst) {
         if (minst->display)
         if ((code = display_set_callback(minst, minst->display)) < 0)
             return code;
+        if (minst->band)
+        if ((code = band_set_callback(minst, minst->band)) < 0)
+            return code;
 
         if ((code = gs_main_run_string(minst,
                 "JOBSERVER "
@@ -857,6 +860,7 @@ gs_finit_push_systemdict(i_ctx_t *i_ctx_p)
     }
     dsp++;
     ref_assign(dsp, systemdict);
+    dict_set_top();
 }
 
 /* Free all resources and return. */
@@ -1085,6 +1089,20 @@ print_resource_usage(const gs_main_instance * minst, gs_dual_memory_t * dmem,
               msg, utime[0] - minst->base_time[0] +
               (utime[1] - minst->base_time[1]) / 1000000000.0,
               status.allocated, used, status.max_used);
+    for (i = 0; i < countof(dmem->gc_stats); ++i) {
+        const struct gc_stats_s *pstats = &dmem->gc_stats[i];
+
+        if (pstats->count == 0)
+            continue;
+        dmprintf5(minst->heap, "%% %s GC: count = %lu, time = %g, max_time = %g, freed = %lu\n",
+                  (i ? "global" : "local"), pstats->count, pstats->time,
+                  pstats->max_time, pstats->freed);
+    }
+    if (dmem->save_stats.saves != 0)
+        dmprintf6(minst->heap, "%% save: count = %lu, restores = %lu, changes = %lu, scanned = %lu, time = %g, max_time = %g\n",
+                  dmem->save_stats.saves, dmem->save_stats.restores,
+                  dmem->save_stats.changes, dmem->save_stats.scanned,
+                  dmem->save_stats.time, dmem->save_stats.max_time);
 }
 
 /* Dump the stacks after interpretation */
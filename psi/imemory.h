@@ -90,6 +90,23 @@ struct gs_dual_memory_s {
     /* Masks for store checking, see isave.h. */
     uint test_mask;
     uint new_mask;
+    /* Garbage collection statistics, reported by -Z: */
+    /* [0] = local-only collections, [1] = global collections. */
+    struct gc_stats_s {
+        ulong count;		/* # of collections */
+        double time;		/* total elapsed time (seconds) */
+        double max_time;	/* longest single collection */
+        ulong freed;		/* total bytes reclaimed */
+    } gc_stats[2];
+    /* Save/restore statistics, also reported by -Z: */
+    struct save_stats_s {
+        ulong saves;		/* # of visible saves */
+        ulong restores;		/* # of visible restore steps */
+        ulong changes;		/* total slots undone by restore */
+        ulong scanned;		/* total bytes scanned for l_new */
+        double time;		/* total elapsed time (seconds) */
+        double max_time;	/* longest single restore */
+    } save_stats;
 };
 
 #define public_st_gs_dual_memory()	/* in ialloc.c */\
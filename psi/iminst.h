@@ -75,6 +75,7 @@ struct gs_main_instance_s {
                                  * GS_NO_UTF8 builds, these will actually
                                  * just be 8 bit clean values). */
     display_callback *display;	/* callback structure for display device */
+    band_callback *band;	/* callback structure for band devices */
     /* The following are updated dynamically. */
     i_ctx_t *i_ctx_p;		/* current interpreter context state */
     char *saved_pages_initial_arg;	/* used to defer processing of --saved-pages=begin... */
@@ -283,6 +283,16 @@ names_invalidate_value_cache(name_table * nt, const ref * pnref)
     pnref->value.pname->pvalue = pv_other;
 }
 
+/* Invalidate the entire dictionary stack lookup cache. */
+void
+names_invalidate_lookup_cache(name_table * nt)
+{
+    if (++(nt->lookup_generation) == 0) {
+        /* The generation wrapped: old entries could look valid again. */
+        memset(nt->lookup_cache, 0, sizeof(nt->lookup_cache));
+    }
+}
+
 /* Convert between names and indices. */
 #undef names_index
 name_index_t
@@ -394,6 +404,9 @@ names_trace_finish(name_table * nt, gc_state_t * gcst)
     uint *phash = &nt->hash[0];
     int i;
 
+    /* Free names may be reused, and dictionaries may move. */
+    names_invalidate_lookup_cache(nt);
+
     for (i = 0; i < NT_HASH_SIZE; phash++, i++) {
         name_index_t prev = 0;
         /*
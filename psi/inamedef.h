@@ -88,6 +88,32 @@ typedef struct name_sub_table_s {
 #endif
 } name_sub_table;
 
+/*
+ * Define the name lookup cache.  Names whose pvalue is pv_other must be
+ * looked up on the dictionary stack; the cache remembers the value slot
+ * found by the last such lookup.  An entry is valid only if its
+ * generation equals the table's lookup_generation, which is advanced
+ * whenever the dictionary stack changes or a dictionary on it may have
+ * moved (begin, end, restore, garbage collection, context switch).
+ * Defining or undefining a name clears that name's entry, since the new
+ * definition may shadow the cached one.  See idstack.c.
+ */
+#define nt_lookup_cache_size 1024	/* must be a power of 2 */
+typedef struct name_lookup_cache_entry_s {
+    uint nidx;			/* 0 = empty, index 0 is never used */
+    uint generation;
+    ref *pvalue;
+} name_lookup_cache_entry;
+#define names_lookup_cache_entry(nt, index)\
+  (&(nt)->lookup_cache[(index) & (nt_lookup_cache_size - 1)])
+#define names_lookup_cache_clear_name(nt, index)\
+  BEGIN\
+    uint index_ = (index);\
+    name_lookup_cache_entry *pce_ = names_lookup_cache_entry(nt, index_);\
+    if (pce_->nidx == index_)\
+        pce_->nidx = 0;\
+  END
+
 /*
  * Now define the name table itself.
  * This must be made visible so that the interpreter can use the
@@ -108,6 +134,8 @@ struct name_table_s {
         name_sub_table *names;
         name_string_sub_table_t *strings;
     } sub[max_name_index / nt_sub_size + 1];
+    uint lookup_generation;	/* see name_lookup_cache_entry above */
+    name_lookup_cache_entry lookup_cache[nt_lookup_cache_size];
 };
 /*typedef struct name_table_s name_table; *//* in inames.h */
 
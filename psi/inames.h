@@ -88,6 +88,9 @@ int names_from_string(name_table * nt, const ref * psref, ref * pnref);
 /* Invalidate the value cache for a name. */
 void names_invalidate_value_cache(name_table * nt, const ref * pnref);
 
+/* Invalidate the entire dictionary stack lookup cache. */
+void names_invalidate_lookup_cache(name_table * nt);
+
 /* Convert between names and indices. */
 name_index_t names_index(const name_table * nt, const ref * pnref);		/* ref => index */
 name *names_index_ptr(const name_table * nt, name_index_t nidx);	/* index => name */
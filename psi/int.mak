@@ -107,7 +107,7 @@ $(PSOBJ)ialloc.$(OBJ) : $(PSSRC)ialloc.c $(AK) $(memory__h) $(gx_h)\
 # but since all the GC enumeration and relocation routines refer to them,
 # it's too hard to separate them out from the Level 1 base.
 $(PSOBJ)igc.$(OBJ) : $(PSSRC)igc.c $(GH) $(memory__h)\
- $(ierrors_h) $(gsexit_h) $(gsmdebug_h) $(gsstruct_h)\
+ $(ierrors_h) $(gsexit_h) $(gsmdebug_h) $(gsstruct_h) $(gxsync_h)\
  $(iastate_h) $(idict_h) $(igc_h) $(igcstr_h) $(inamedef_h)\
  $(ipacked_h) $(isave_h) $(isstate_h) $(istruct_h) $(opdef_h) \
  $(INT_MAK) $(MAKEDIRS)
@@ -136,7 +136,7 @@ $(PSOBJ)iname.$(OBJ) : $(PSSRC)iname.c $(GH) $(memory__h) $(string__h)\
  $(INT_MAK) $(MAKEDIRS)
 	$(PSCC) $(PSO_)iname.$(OBJ) $(C_) $(PSSRC)iname.c
 
-$(PSOBJ)isave.$(OBJ) : $(PSSRC)isave.c $(GH) $(memory__h)\
+$(PSOBJ)isave.$(OBJ) : $(PSSRC)isave.c $(GH) $(memory__h) $(gp_h)\
  $(ierrors_h) $(gsexit_h) $(gsstruct_h) $(gsutil_h)\
  $(iastate_h) $(iname_h) $(inamedef_h) $(isave_h) $(isstate_h) $(ivmspace_h)\
  $(ipacked_h) $(store_h) $(stream_h) $(igc_h) $(icstate_h) $(gsstate_h) \
@@ -1029,7 +1029,7 @@ $(PSOBJ)zusparam.$(OBJ) : $(PSSRC)zusparam.c $(OP) $(memory__h) $(string__h)\
  $(ialloc_h) $(icontext_h) $(idict_h) $(idparam_h) $(iparam_h)\
  $(iname_h) $(itoken_h) $(iutil2_h) $(ivmem2_h)\
  $(dstack_h) $(estack_h) $(store_h) $(gsnamecl_h) $(gslibctx_h)\
- $(INT_MAK) $(MAKEDIRS)
+ $(gxpcolor_h) $(INT_MAK) $(MAKEDIRS)
 	$(PSCC) $(PSO_)zusparam.$(OBJ) $(C_) $(PSSRC)zusparam.c
 
 # Define full Level 2 support.
@@ -1915,7 +1915,7 @@ $(PSOBJ)apitest.$(OBJ) : $(PSSRC)apitest.c $(GH)\
 
 $(PSOBJ)iapi.$(OBJ) : $(PSSRC)iapi.c $(AK)\
  $(string__h) $(ierrors_h) $(gscdefs_h) $(gstypes_h) $(iapi_h)\
- $(iref_h) $(imain_h) $(imainarg_h) $(iminst_h) $(gslibctx_h)\
+ $(iref_h) $(imain_h) $(imainarg_h) $(iminst_h) $(gslibctx_h) $(idisp_h)\
  $(INT_MAK) $(MAKEDIRS)
 	$(PSCC) $(PSO_)iapi.$(OBJ) $(C_) $(PSSRC)iapi.c
 
@@ -1928,12 +1928,15 @@ $(PSOBJ)icontext.$(OBJ) : $(PSSRC)icontext.c $(GH)\
 
 gdevdsp_h=$(DEVSRCDIR)$(D)gdevdsp.h
 gdevdsp2_h=$(DEVSRCDIR)$(D)gdevdsp2.h
+gdevband_h=$(DEVSRCDIR)$(D)gdevband.h
+gdevband2_h=$(DEVSRCDIR)$(D)gdevband2.h
 
 $(PSOBJ)idisp.$(OBJ) : $(PSSRC)idisp.c $(OP) $(stdio__h) $(gp_h)\
  $(stdpre_h) $(gscdefs_h) $(gsdevice_h) $(gsmemory_h) $(gstypes_h)\
  $(iapi_h) $(iref_h)\
  $(imain_h) $(iminst_h) $(idisp_h) $(ostack_h)\
  $(gx_h) $(gxdevice_h) $(gxdevmem_h) $(gdevdsp_h) $(gdevdsp2_h)\
+ $(gdevprn_h) $(gxdownscale_h) $(gdevband_h) $(gdevband2_h)\
  $(INT_MAK) $(MAKEDIRS)
 	$(PSCC) $(I_)$(DEVSRCDIR) $(PSO_)idisp.$(OBJ) $(C_) $(PSSRC)idisp.c
 
@@ -1972,7 +1975,7 @@ $(PSOBJ)interp.$(OBJ) : $(PSSRC)interp.c $(GH) $(memory__h) $(string__h)\
 	$(PSCC) $(PSO_)interp.$(OBJ) $(C_) $(PSSRC)interp.c
 
 $(PSOBJ)ireclaim.$(OBJ) : $(PSSRC)ireclaim.c $(GH)\
- $(gsstruct_h)\
+ $(gp_h) $(gsstruct_h)\
  $(iastate_h) $(icontext_h) $(interp_h) $(isave_h) $(isstate_h)\
  $(dstack_h) $(ierrors_h) $(estack_h) $(opdef_h) $(ostack_h) $(store_h)\
  $(INT_MAK) $(MAKEDIRS)
@@ -16,6 +16,7 @@
 
 /* Interpreter's interface to garbage collector */
 #include "ghost.h"
+#include "gp.h"			/* for gp_get_realtime */
 #include "ierrors.h"
 #include "gsstruct.h"
 #include "iastate.h"
@@ -113,9 +114,13 @@ gs_vmreclaim(gs_dual_memory_t *dmem, bool global)
     gs_ref_memory_t *memories[5];
     gs_ref_memory_t *mem;
     int nmem, i;
+    long start_time[2], end_time[2];
+    ulong used_before = 0, used_after = 0;
+    gs_memory_status_t status;
 
     if (code < 0)
         return code;
+    gp_get_realtime(start_time);
 
     memories[0] = dmem->space_system;
     memories[1] = mem = dmem->space_global;
@@ -129,8 +134,11 @@ gs_vmreclaim(gs_dual_memory_t *dmem, bool global)
     }
 
     /****** ABORT IF code < 0 ******/
-    for (i = nmem; --i >= 0; )
+    for (i = nmem; --i >= 0; ) {
         alloc_close_clump(memories[i]);
+        gs_memory_status((gs_memory_t *)memories[i], &status);
+        used_before += status.used;
+    }
 
     /* Prune the file list so it won't retain potentially collectible */
     /* files. */
@@ -176,8 +184,31 @@ gs_vmreclaim(gs_dual_memory_t *dmem, bool global)
 
     /* Reopen the active clumps. */
 
-    for (i = 0; i < nmem; ++i)
+    for (i = 0; i < nmem; ++i) {
+        gs_memory_status((gs_memory_t *)memories[i], &status);
+        used_after += status.used;
         alloc_open_clump(memories[i]);
+    }
+
+    /* Record the statistics reported by -Z:. */
+
+    gp_get_realtime(end_time);
+    {
+        struct gc_stats_s *pstats = &dmem->gc_stats[global ? 1 : 0];
+        double elapsed = end_time[0] - start_time[0] +
+            (end_time[1] - start_time[1]) / 1000000000.0;
+
+        pstats->count++;
+        pstats->time += elapsed;
+        if (elapsed > pstats->max_time)
+            pstats->max_time = elapsed;
+        if (used_before > used_after)
+            pstats->freed += used_before - used_after;
+        if_debug4m('0', (gs_memory_t *)lmem,
+                   "[0]%s GC: %g s, used %lu => %lu\n",
+                   (global ? "global" : "local"), elapsed,
+                   used_before, used_after);
+    }
 
     /* Reload the context state.  Note this should be done
        AFTER the clumps are reopened, since the context state
@@ -17,6 +17,7 @@
 /* Save/restore manager for Ghostscript interpreter */
 #include "ghost.h"
 #include "memory_.h"
+#include "gp.h"			/* for gp_get_realtime */
 #include "ierrors.h"
 #include "gsexit.h"
 #include "gsstruct.h"
@@ -149,6 +150,60 @@ static const long min_inner_clump_space = sizeof(clump_head_t) + 500;
  * not by the current allocation mode.
  */
 
+/*
+ * The cost of a restore is thus proportional to the number of slots
+ * changed since the save plus the number of objects allocated since the
+ * save (which must be finalized), and, for inner saves, the amount of data
+ * scanned to reset l_new.  We keep running totals of these in the
+ * gs_dual_memory_t, reported by -Z:, which also prints the cost of each
+ * individual restore.
+ *
+ * These statistics are only the first step towards a copy-on-write
+ * restore, where a page that rewrites much of an old object pays for one
+ * copy of the object rather than for an alloc_change_t per slot.  The
+ * intended design is:
+ *
+ * To record a change (alloc_save_change_in):
+ *      Count the changes recorded at this save level against the
+ *        enclosing refs object (not the clump: a clump also holds C
+ *        structures whose non-ref fields restore does not undo, and
+ *        which a clump copy would wrongly roll back).
+ *      When the count for an object older than the save exceeds a
+ *        fraction of its size, copy the object's refs into a snapshot
+ *        clump owned by the save, set l_new in all of its slots so that
+ *        later stores record nothing, and mark its alloc_change_t
+ *        entries as superseded.
+ *
+ * To do a restore:
+ *      Copy each snapshot back over its object (this also restores the
+ *        l_new bits as they were at the save), then undo the remaining
+ *        changes as now, skipping superseded ones.
+ *      Free the snapshot clumps whole, as restore already frees the
+ *        clumps allocated since the save.
+ *
+ * To do a save or forget a save:
+ *      Treat the snapshotted objects like slots on the contents chain
+ *        when resetting or setting l_new.  When forgetting, move a
+ *        snapshot to the next outer save unless that save already has
+ *        one of the same object.
+ *
+ * The garbage collector must trace the snapshot refs from the save
+ * record, as it does the contents of the alloc_change_t chain, and
+ * relocate the object pointer of each snapshot, since compaction can
+ * move the object.  The changes and scanned totals above give the
+ * threshold to use, and show which jobs would benefit.
+ */
+
+/* Return the elapsed time since *start, in seconds. */
+static double
+save_elapsed_time(const long *start)
+{
+    long now[2];
+
+    gp_get_realtime(now);
+    return now[0] - start[0] + (now[1] - start[1]) / 1000000000.0;
+}
+
 /* Tracing printout */
 static void
 print_save(const char *str, uint spacen, const alloc_save_t *sav)
@@ -333,9 +388,14 @@ alloc_save_state(gs_dual_memory_t * dmem, void *cdata, ulong *psid)
     bool global =
         lmem->save_level == 0 && gmem != lmem &&
         gmem->num_contexts == 1;
-    alloc_save_t *gsave =
+    long start_time[2];
+    alloc_save_t *gsave;
+    alloc_save_t *lsave;
+
+    gp_get_realtime(start_time);
+    gsave =
         (global ? alloc_save_space(gmem, dmem, sid + 1) : (alloc_save_t *) 0);
-    alloc_save_t *lsave = alloc_save_space(lmem, dmem, sid);
+    lsave = alloc_save_space(lmem, dmem, sid);
 
     if (lsave == 0 || (global && gsave == 0)) {
         /* Only 1 of lsave or gsave will have been allocated, but
@@ -367,6 +427,7 @@ alloc_save_state(gs_dual_memory_t * dmem, void *cdata, ulong *psid)
 
         if (code < 0)
             return code;
+        dmem->save_stats.scanned += scanned;
 #if 0 /* Disable invisible save levels. */
         if ((lsave->state.total_scanned += scanned) > max_repeated_scan) {
             /* Do a second, invisible save. */
@@ -397,6 +458,8 @@ alloc_save_state(gs_dual_memory_t * dmem, void *cdata, ulong *psid)
 
     alloc_set_in_save(dmem);
     *psid = sid;
+    dmem->save_stats.saves++;
+    dmem->save_stats.time += save_elapsed_time(start_time);
     return 0;
 }
 /* Save the state of one space (global or local). */
@@ -749,6 +812,12 @@ alloc_restore_step_in(gs_dual_memory_t *dmem, alloc_save_t * save)
     gs_ref_memory_t *mem = lmem;
     alloc_save_t *sprev;
     int code;
+    long start_time[2];
+    ulong changes = dmem->save_stats.changes;
+    ulong scanned = 0;
+    double elapsed;
+
+    gp_get_realtime(start_time);
 
     /* Finalize all objects before releasing resources or undoing changes. */
     do {
@@ -799,13 +868,23 @@ alloc_restore_step_in(gs_dual_memory_t *dmem, alloc_save_t * save)
         }
         alloc_set_not_in_save(dmem);
     } else {			/* Set the l_new attribute in all slots that are now new. */
-        ulong scanned;
-
         code = save_set_new(mem, true, false, &scanned);
         if (code < 0)
             return code;
     }
 
+    elapsed = save_elapsed_time(start_time);
+    dmem->save_stats.restores++;
+    dmem->save_stats.scanned += scanned;
+    dmem->save_stats.time += elapsed;
+    if (elapsed > dmem->save_stats.max_time)
+        dmem->save_stats.max_time = elapsed;
+    if (gs_debug[':'])
+        dmprintf4((const gs_memory_t *)lmem,
+                  "%% restore to level %d: changes = %lu, scanned = %lu, time = %g\n",
+                  lmem->save_level, dmem->save_stats.changes - changes,
+                  scanned, elapsed);
+
     return sprev == save;
 }
 /* Restore the memory of one space, by undoing changes and freeing */
@@ -821,6 +900,7 @@ restore_space(gs_ref_memory_t * mem, gs_dual_memory_t *dmem)
     /* Undo changes since the save. */
     {
         register alloc_change_t *cp = mem->changes;
+        ulong count = 0;
 
         while (cp) {
 #ifdef DEBUG
@@ -837,7 +917,11 @@ restore_space(gs_ref_memory_t * mem, gs_dual_memory_t *dmem)
             else
                 ref_assign_inline((ref *) cp->where, &cp->contents);
             cp = cp->next;
+            count++;
         }
+        dmem->save_stats.changes += count;
+        /* Dictionary contents may have changed under the lookup cache. */
+        names_invalidate_lookup_cache(mem->gs_lib_ctx->gs_name_table);
     }
 
     /* Free memory allocated since the save. */
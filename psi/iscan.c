@@ -921,13 +921,36 @@ gs_scan_token(i_ctx_t *i_ctx_p, ref * pref, scanner_state * pstate)
             retcode = scan_number(sptr + (sign & 1),
                     endptr /*(*endptr == char_CR ? endptr : endptr + 1) */ ,
                                   sign, myref, &newptr, i_ctx_p->scanner_options);
-            if (retcode == 1 && decoder[newptr[-1]] == ctype_space) {
-                sptr = newptr - 1;
-                if (*sptr == char_CR && sptr[1] == char_EOL)
-                    sptr++;
-                retcode = 0;
-                ref_mark_new(myref);
-                break;
+            if (retcode == 1) {
+                c = newptr[-1];
+                switch (decoder[c]) {
+                    case ctype_space:
+                        sptr = newptr - 1;
+                        if (*sptr == char_CR && sptr[1] == char_EOL)
+                            sptr++;
+                        retcode = 0;
+                        ref_mark_new(myref);
+                        goto sret;
+                    case ctype_btoken:
+                        if (max_name_ctype != ctype_name)
+                            break;
+                        /* falls through */
+                    case ctype_other:
+                        /*
+                         * The number was ended by a self-delimiting
+                         * character, as in [1 2] or -250(x) in a TJ array.
+                         * Every character the number scanner consumed is a
+                         * name character, so rescanning the token as a name
+                         * would stop at the same place and yield the same
+                         * number: leave the delimiter for the next token.
+                         */
+                        if (c == ctrld)
+                            break;
+                        sptr = newptr - 2;
+                        retcode = 0;
+                        ref_mark_new(myref);
+                        goto sret;
+                }
             }
             name_type = 0;
             try_number = true;
@@ -67,6 +67,49 @@ scan_number(const byte * str, const byte * end, int sign,
 #define WOULD_OVERFLOW(val, d, maxv)\
   (val >= maxv / 10 && (val > maxv / 10 || d > (int64_t)(maxv % 10)))
 
+    /*
+     * Fast path for the overwhelmingly common case of a short decimal
+     * integer or real, such as the coordinates in a PDF content stream:
+     * at most 9 digits in all (so the value can't overflow, even in CPSI
+     * mode), at most NUM_POWERS_10 of them after the point, and followed
+     * within the buffer by a character that can't continue the number.
+     * Anything else falls through to the general code below, which
+     * produces exactly the same results for these cases.
+     */
+    {
+        const byte *p = sp;
+        int ndigits = 0;
+
+        ival = 0;
+        while (p < end && (d = decoder[*p]) < 10 && ndigits < 9)
+            ival = ival * 10 + d, p++, ndigits++;
+        if (ndigits != 0 && p < end) {
+            c = *p++;
+            if (c == '.') {
+                int nfrac = 0;
+
+                while (p < end && (d = decoder[*p]) < 10 && ndigits < 9)
+                    ival = ival * 10 + d, p++, ndigits++, nfrac++;
+                if (p < end && nfrac <= NUM_POWERS_10) {
+                    c = *p++;
+                    if (!(c == 'e' || c == 'E' || c == '-' ||
+                          decoder[c] < 10)) {
+                        if (sign < 0)
+                            ival = -ival;
+                        make_real(pref, ival * neg_powers_10[nfrac]);
+                        *psp = p;
+                        return 1;
+                    }
+                }
+            } else if (!(c == 'e' || c == 'E' || c == '#' ||
+                         decoder[c] < 10)) {
+                make_int(pref, (sign < 0 ? -ival : ival));
+                *psp = p;
+                return 1;
+            }
+        }
+    }
+
     GET_NEXT(c, sp, return_error(gs_error_syntaxerror));
     if (!IS_DIGIT(d, c)) {
         if (c != '.')
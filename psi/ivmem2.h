@@ -22,5 +22,7 @@
 /* Exported by zvmem2.c for zusparam.c */
 int set_vm_reclaim(i_ctx_t *, long);
 int set_vm_threshold(i_ctx_t *, long);
+int set_vm_threshold_scale(i_ctx_t *, long);
+int set_gc_threads(i_ctx_t *, long);
 
 #endif /* ivmem2_INCLUDED */
@@ -60,7 +60,7 @@ zpcolor_init(i_ctx_t *i_ctx_p)
 {
     gx_pattern_cache *pc = gx_pattern_alloc_cache(imemory_system,
                                                   gx_pat_cache_default_tiles(),
-                                                  gx_pat_cache_default_bits());
+                                                  gx_pat_cache_interp_bits());
     if (pc == NULL)
 	return_error(gs_error_VMerror);
     gstate_set_pattern_cache(igs, pc);
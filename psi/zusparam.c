@@ -43,6 +43,7 @@
 #include "gsparamx.h"
 #include "gx.h"
 #include "gxgstate.h"
+#include "gxpcolor.h"		/* for MaxPatternCache */
 #include "gslibctx.h"
 
 
@@ -158,6 +159,25 @@ set_MaxFontCache(i_ctx_t *i_ctx_p, long val)
                                    val));
 }
 static long
+current_MaxPatternCache(i_ctx_t *i_ctx_p)
+{
+    gx_pattern_cache *pcache = gstate_pattern_cache(igs);
+
+    return (pcache == 0 ? 0 : pcache->max_bits);
+}
+static int
+set_MaxPatternCache(i_ctx_t *i_ctx_p, long val)
+{
+    gx_pattern_cache *pcache = gstate_pattern_cache(igs);
+
+    if (pcache == 0)
+        return 0;
+    pcache->max_bits = val;
+    /* Free tiles until the cache fits the new size. */
+    gx_pattern_cache_ensure_space(igs, 0);
+    return 0;
+}
+static long
 current_CurFontCache(i_ctx_t *i_ctx_p)
 {
     uint cstat[7];
@@ -208,6 +228,8 @@ static const long_param_def_t system_long_params[] =
     {"BuildTime", min_long, max_long, current_BuildTime, NULL},
 {"MaxFontCache", 0, MAX_UINT_PARAM, current_MaxFontCache, set_MaxFontCache},
     {"CurFontCache", 0, MAX_UINT_PARAM, current_CurFontCache, NULL},
+    {"MaxPatternCache", 0, max_long,
+     current_MaxPatternCache, set_MaxPatternCache},
     {"Revision", min_long, max_long, current_Revision, NULL},
     {"PageCount", min_long, max_long, current_PageCount, NULL},
 
@@ -429,6 +451,33 @@ current_VMThreshold(i_ctx_t *i_ctx_p)
     return stat.vm_threshold;
 }
 static long
+current_VMThresholdScale(i_ctx_t *i_ctx_p)
+{
+    gs_memory_gc_status_t stat;
+
+    gs_memory_gc_status(iimemory_local, &stat);
+    return stat.vm_threshold_scale;
+}
+static long
+current_NumGCThreads(i_ctx_t *i_ctx_p)
+{
+    gs_memory_gc_status_t stat;
+
+    gs_memory_gc_status(iimemory_global, &stat);
+    return stat.num_threads;
+}
+static long
+current_MinThreadedDecodeSize(i_ctx_t *i_ctx_p)
+{
+    return imemory->gs_lib_ctx->min_threaded_decode;
+}
+static int
+set_MinThreadedDecodeSize(i_ctx_t *i_ctx_p, long val)
+{
+    imemory->gs_lib_ctx->min_threaded_decode = val;
+    return 0;
+}
+static long
 current_WaitTimeout(i_ctx_t *i_ctx_p)
 {
     return 0;
@@ -593,6 +642,12 @@ static const long_param_def_t user_long_params[] =
     {"WaitTimeout", 0, MAX_UINT_PARAM,
      current_WaitTimeout, set_WaitTimeout},
     /* Extensions */
+    {"VMThresholdScale", 0, 10000,
+     current_VMThresholdScale, set_vm_threshold_scale},
+    {"NumGCThreads", 0, 64,
+     current_NumGCThreads, set_gc_threads},
+    {"MinThreadedDecodeSize", 0, max_long,
+     current_MinThreadedDecodeSize, set_MinThreadedDecodeSize},
     {"MinScreenLevels", 0, MAX_UINT_PARAM,
      current_MinScreenLevels, set_MinScreenLevels},
     {"AlignToPixels", 0, 1,
@@ -92,6 +92,28 @@ set_vm_threshold(i_ctx_t *i_ctx_p, long val)
     return 0;
 }
 
+int
+set_vm_threshold_scale(i_ctx_t *i_ctx_p, long val)
+{
+    if (val < 0)
+        return_error(gs_error_rangecheck);
+    gs_memory_set_vm_threshold_scale(idmemory->space_system, (int)val);
+    gs_memory_set_vm_threshold_scale(idmemory->space_global, (int)val);
+    gs_memory_set_vm_threshold_scale(idmemory->space_local, (int)val);
+    return 0;
+}
+
+int
+set_gc_threads(i_ctx_t *i_ctx_p, long val)
+{
+    if (val < 0)
+        return_error(gs_error_rangecheck);
+    gs_memory_set_gc_threads(idmemory->space_system, (int)val);
+    gs_memory_set_gc_threads(idmemory->space_global, (int)val);
+    gs_memory_set_gc_threads(idmemory->space_local, (int)val);
+    return 0;
+}
+
 int
 set_vm_reclaim(i_ctx_t *i_ctx_p, long val)
 {